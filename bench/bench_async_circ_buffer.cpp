@@ -0,0 +1,65 @@
+#include "raphia/async_circ_buffer.hpp"
+#include "raphia/blocking_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <thread>
+
+namespace
+{
+    constexpr std::uint64_t items = 1 << 18;
+
+    // one producer and one consumer passing items through a ring of state.range(0) slots,
+    // a capacity of 1 forces a switch between them on every item
+
+    raphia::task produce(raphia::async_circ_buffer<std::uint64_t> &circ)
+    {
+        for (std::uint64_t i = 0; i < items; ++i)
+            co_await circ.async_push(i);
+        circ.close();
+    }
+
+    raphia::task consume(raphia::async_circ_buffer<std::uint64_t> &circ, std::uint64_t &sum)
+    {
+        while (auto value = co_await circ.async_pop())
+            sum += *value;
+    }
+
+    void pipeline_coroutines(benchmark::State &state)
+    {
+        for (auto _ : state)
+        {
+            raphia::single_thread_executor executor;
+            raphia::async_circ_buffer<std::uint64_t> circ(static_cast<std::size_t>(state.range(0)), executor);
+            std::uint64_t sum = 0;
+            executor.spawn(produce(circ));
+            executor.spawn(consume(circ, sum));
+            executor.run();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+    }
+
+    void pipeline_threads(benchmark::State &state)
+    {
+        for (auto _ : state)
+        {
+            raphia::blocking_circ_buffer<std::uint64_t> circ(static_cast<std::size_t>(state.range(0)));
+            std::uint64_t sum = 0;
+            std::thread consumer([&circ, &sum] {
+                std::uint64_t batch[64];
+                while (auto count = circ.pop_bulk(batch, 64))
+                    for (std::size_t i = 0; i < count; ++i)
+                        sum += batch[i];
+            });
+            for (std::uint64_t i = 0; i < items; ++i)
+                circ.push(i);
+            circ.close();
+            consumer.join();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+    }
+} // namespace
+
+BENCHMARK(pipeline_coroutines)->Arg(1)->Arg(1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(pipeline_threads)->Arg(1)->Arg(1024)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,123 @@
+#include "raphia/blocking_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t capacity = 1024;
+    constexpr std::uint64_t items = 1 << 18;
+
+    /** circ_buffer behind a mutex and two condition variables, every push notifies a consumer
+     * and every pop a producer, the way a worker pool queue is usually written */
+    class condvar_circ_buffer
+    {
+    public:
+        explicit condvar_circ_buffer(std::size_t count) : circ_(count), closed_(false) {}
+
+        void push(std::uint64_t value)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return circ_.size() < circ_.capacity(); });
+            circ_.push_back(value);
+            lock.unlock();
+            not_empty_.notify_one();
+        }
+
+        bool pop(std::uint64_t &value)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return !circ_.empty() || closed_; });
+            if (circ_.empty())
+                return false;
+            value = circ_.front();
+            circ_.pop_front();
+            lock.unlock();
+            not_full_.notify_one();
+            return true;
+        }
+
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+            }
+            not_empty_.notify_all();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable not_empty_;
+        std::condition_variable not_full_;
+        raphia::circ_buffer<std::uint64_t> circ_;
+        bool closed_;
+    };
+
+    /** producers push all items, consumers drain until close */
+    template <class Push, class Consume, class Close>
+    void run(std::uint64_t producers, std::uint64_t consumers, Push push, Consume consume, Close close)
+    {
+        std::vector<std::thread> threads;
+        for (std::uint64_t c = 0; c < consumers; ++c)
+            threads.emplace_back(consume);
+        std::vector<std::thread> producer_threads;
+        for (std::uint64_t p = 0; p < producers; ++p)
+            producer_threads.emplace_back([push, p, producers] {
+                for (auto i = p; i < items; i += producers)
+                    push(i);
+            });
+        for (auto &t : producer_threads)
+            t.join();
+        close();
+        for (auto &t : threads)
+            t.join();
+    }
+
+    /** range(0) producers hand items to range(1) consumers */
+    void worker_pool_condvar(benchmark::State &state)
+    {
+        auto producers = static_cast<std::uint64_t>(state.range(0));
+        auto consumers = static_cast<std::uint64_t>(state.range(1));
+        for (auto _ : state)
+        {
+            condvar_circ_buffer circ(capacity);
+            run(producers, consumers, [&circ](std::uint64_t i) { circ.push(i); },
+                [&circ] {
+                    std::uint64_t value, sum = 0;
+                    while (circ.pop(value))
+                        sum += value;
+                    benchmark::DoNotOptimize(sum);
+                },
+                [&circ] { circ.close(); });
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+    }
+
+    void worker_pool_bulk(benchmark::State &state)
+    {
+        auto producers = static_cast<std::uint64_t>(state.range(0));
+        auto consumers = static_cast<std::uint64_t>(state.range(1));
+        for (auto _ : state)
+        {
+            raphia::blocking_circ_buffer<std::uint64_t, std::allocator<std::uint64_t>, raphia::pow2_index> circ(capacity);
+            run(producers, consumers, [&circ](std::uint64_t i) { circ.push(i); },
+                [&circ] {
+                    std::uint64_t batch[64], sum = 0;
+                    std::size_t count;
+                    while ((count = circ.pop_bulk(batch, 64)) > 0)
+                        for (std::size_t i = 0; i < count; ++i)
+                            sum += batch[i];
+                    benchmark::DoNotOptimize(sum);
+                },
+                [&circ] { circ.close(); });
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+    }
+} // namespace
+
+BENCHMARK(worker_pool_condvar)->Args({1, 1})->Args({2, 2})->Args({4, 4})->ArgNames({"producers", "consumers"})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(worker_pool_bulk)->Args({1, 1})->Args({2, 2})->Args({4, 4})->ArgNames({"producers", "consumers"})->UseRealTime()->Unit(benchmark::kMillisecond);
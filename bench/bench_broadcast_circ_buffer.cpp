@@ -0,0 +1,96 @@
+#include "raphia/broadcast_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace
+{
+    // one stream fanned out to state.range(0) consumers, every consumer drains its
+    // backlog after each batch. The copies variant keeps one spsc_circ_buffer per
+    // consumer, so the writer pays for every consumer and the memory grows with them.
+    constexpr std::size_t capacity = 1024;
+    constexpr std::size_t batch = 256;
+
+    struct message
+    {
+        std::uint64_t sequence;
+        char payload[56];
+    };
+
+    void fan_out_broadcast(benchmark::State &state)
+    {
+        using buffer_type = raphia::broadcast_circ_buffer<message, std::allocator<message>, raphia::pow2_index>;
+        buffer_type circ(capacity);
+        std::vector<buffer_type::reader> readers(static_cast<std::size_t>(state.range(0)), buffer_type::reader(circ));
+        message m{};
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                ++m.sequence;
+                circ.push(m);
+            }
+            for (auto &reader : readers)
+                while (reader.try_pop(m))
+                    benchmark::DoNotOptimize(m);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+        state.counters["buffer_bytes"] = static_cast<double>(capacity * sizeof(message));
+    }
+
+    using spsc_buffer = raphia::spsc_circ_buffer<message, std::allocator<message>, raphia::pow2_index>;
+    using spsc_allocator = raphia::cache_aligned_allocator<spsc_buffer>;
+
+    /** spsc_circ_buffer pads its counters onto cache lines of their own, plain new
+     * doesn't honour that alignment before C++17 */
+    struct spsc_deleter
+    {
+        void operator()(spsc_buffer *p) const noexcept
+        {
+            p->~spsc_buffer();
+            spsc_allocator().deallocate(p, 1);
+        }
+    };
+
+    std::unique_ptr<spsc_buffer, spsc_deleter> make_spsc_buffer(std::size_t count)
+    {
+        spsc_allocator alloc;
+        auto p = alloc.allocate(1);
+        try
+        {
+            return std::unique_ptr<spsc_buffer, spsc_deleter>(new (p) spsc_buffer(count));
+        }
+        catch (...)
+        {
+            alloc.deallocate(p, 1);
+            throw;
+        }
+    }
+
+    void fan_out_copies(benchmark::State &state)
+    {
+        std::vector<std::unique_ptr<spsc_buffer, spsc_deleter>> copies;
+        for (int64_t r = 0; r < state.range(0); ++r)
+            copies.emplace_back(make_spsc_buffer(capacity));
+        message m{};
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                ++m.sequence;
+                for (auto &copy : copies)
+                    copy->try_push(m);
+            }
+            for (auto &copy : copies)
+                while (copy->try_pop(m))
+                    benchmark::DoNotOptimize(m);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+        state.counters["buffer_bytes"] = static_cast<double>(copies.size() * capacity * sizeof(message));
+    }
+} // namespace
+
+BENCHMARK(fan_out_broadcast)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(fan_out_copies)->Arg(1)->Arg(4)->Arg(16);
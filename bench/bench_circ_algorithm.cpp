@@ -0,0 +1,96 @@
+#include "raphia/circ_algorithm.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+    // a 64 KiB byte ring holding one long line that wraps around the end of the storage,
+    // searched for the delimiter like a line protocol parser would
+    constexpr std::size_t ring_size = 64 * 1024;
+
+    template <class T>
+    raphia::circ_buffer<T> make_wrapped(T fill, T last)
+    {
+        raphia::circ_buffer<T> circ(ring_size);
+        for (std::size_t i = 0; i < ring_size + ring_size / 3; ++i)
+            circ.push_back(fill);
+        circ.pop_back();
+        circ.push_back(last);
+        return circ;
+    }
+
+    void find_delimiter_std(benchmark::State &state)
+    {
+        auto circ = make_wrapped<char>('x', '\n');
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::find(circ.cbegin(), circ.cend(), '\n'));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size));
+    }
+
+    void find_delimiter_simd(benchmark::State &state)
+    {
+        auto circ = make_wrapped<char>('x', '\n');
+        for (auto _ : state)
+            benchmark::DoNotOptimize(raphia::find(circ, '\n'));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size));
+    }
+
+    void count_bytes_std(benchmark::State &state)
+    {
+        auto circ = make_wrapped<std::uint8_t>(1, 2);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::count(circ.cbegin(), circ.cend(), std::uint8_t(2)));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size));
+    }
+
+    void count_bytes_simd(benchmark::State &state)
+    {
+        auto circ = make_wrapped<std::uint8_t>(1, 2);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(raphia::count(circ, std::uint8_t(2)));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size));
+    }
+
+    void sum_floats_std(benchmark::State &state)
+    {
+        auto circ = make_wrapped<float>(1.0f, 2.0f);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::accumulate(circ.cbegin(), circ.cend(), 0.0f));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size * sizeof(float)));
+    }
+
+    void sum_floats_simd(benchmark::State &state)
+    {
+        auto circ = make_wrapped<float>(1.0f, 2.0f);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(raphia::sum(circ));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size * sizeof(float)));
+    }
+
+    void min_max_floats_std(benchmark::State &state)
+    {
+        auto circ = make_wrapped<float>(1.0f, 2.0f);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(std::minmax_element(circ.cbegin(), circ.cend()));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size * sizeof(float)));
+    }
+
+    void min_max_floats_simd(benchmark::State &state)
+    {
+        auto circ = make_wrapped<float>(1.0f, 2.0f);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(raphia::min_max(circ));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ring_size * sizeof(float)));
+    }
+} // namespace
+
+BENCHMARK(find_delimiter_std);
+BENCHMARK(find_delimiter_simd);
+BENCHMARK(count_bytes_std);
+BENCHMARK(count_bytes_simd);
+BENCHMARK(sum_floats_std);
+BENCHMARK(sum_floats_simd);
+BENCHMARK(min_max_floats_std);
+BENCHMARK(min_max_floats_simd);
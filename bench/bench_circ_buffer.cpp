@@ -0,0 +1,243 @@
+#include "raphia/circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Both variants get a power of two capacity, so they do the same work
+    // and only differ in the way a counter is mapped onto a slot.
+    constexpr std::size_t capacity = 1024;
+
+    template <class Circ>
+    void push_back_overwrite(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        std::uint32_t value = 0;
+        for (auto _ : state)
+        {
+            circ.push_back(value++);
+            benchmark::DoNotOptimize(circ.back());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Circ>
+    void push_back_pop_front(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        for (std::uint32_t i = 0; i < capacity / 2; ++i)
+            circ.push_back(i);
+        std::uint32_t value = 0;
+        for (auto _ : state)
+        {
+            circ.push_back(value++);
+            benchmark::DoNotOptimize(circ.front());
+            circ.pop_front();
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Circ>
+    void push_front_pop_back(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        for (std::uint32_t i = 0; i < capacity / 2; ++i)
+            circ.push_front(i);
+        std::uint32_t value = 0;
+        for (auto _ : state)
+        {
+            circ.push_front(value++);
+            benchmark::DoNotOptimize(circ.back());
+            circ.pop_back();
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Circ>
+    void random_access(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        for (std::uint32_t i = 0; i < capacity + capacity / 2; ++i)
+            circ.push_back(i);
+        const Circ &ref = circ;
+        int idx = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ref[idx]);
+            idx = (idx + 97) & static_cast<int>(capacity - 1);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Circ>
+    void iterate(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        for (std::uint32_t i = 0; i < capacity + capacity / 2; ++i)
+            circ.push_back(i);
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            for (auto v : circ)
+                sum += v;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    template <class Circ>
+    void iterate_segments(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        for (std::uint32_t i = 0; i < capacity + capacity / 2; ++i)
+            circ.push_back(i);
+        for (auto _ : state)
+        {
+            std::uint32_t sum = 0;
+            raphia::for_each_segment(circ.cbegin(), circ.cend(), [&sum](const std::uint32_t *first, const std::uint32_t *last)
+                                     { sum = std::accumulate(first, last, sum); });
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    template <class Circ>
+    void sort(benchmark::State &state)
+    {
+        Circ circ(capacity);
+        std::uint32_t seed = 1;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (std::size_t i = 0; i < capacity + capacity / 2; ++i)
+                circ.push_back(seed = seed * 1664525u + 1013904223u);
+            state.ResumeTiming();
+            std::sort(circ.begin(), circ.end());
+            benchmark::DoNotOptimize(circ.front());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    // byte and sample streams, chunks of 4 KiB elements pass through a 64 KiB ring
+    constexpr std::size_t stream_capacity = 64 * 1024;
+    constexpr std::size_t chunk = 4096;
+
+    template <class T>
+    void stream_per_element(benchmark::State &state)
+    {
+        raphia::circ_buffer<T> circ(stream_capacity);
+        std::vector<T> in(chunk, T(1)), out(chunk);
+        for (auto _ : state)
+        {
+            for (auto &v : in)
+                circ.push_back(v);
+            auto it = out.begin();
+            while (!circ.empty())
+            {
+                *it++ = circ.front();
+                circ.pop_front();
+            }
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * chunk * sizeof(T)));
+    }
+
+    template <class T>
+    void stream_bulk(benchmark::State &state)
+    {
+        raphia::circ_buffer<T> circ(stream_capacity);
+        std::vector<T> in(chunk, T(1)), out(chunk);
+        for (auto _ : state)
+        {
+            circ.push_back(in.data(), in.data() + in.size());
+            circ.copy_out(out.data(), chunk);
+            circ.pop_front(chunk);
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * chunk * sizeof(T)));
+    }
+
+    template <class T>
+    void stream_overwrite_bulk(benchmark::State &state)
+    {
+        raphia::circ_buffer<T> circ(stream_capacity);
+        std::vector<T> in(chunk, T(1));
+        for (auto _ : state)
+        {
+            circ.push_back(in.begin(), in.end());
+            benchmark::DoNotOptimize(circ.back());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * chunk * sizeof(T)));
+    }
+
+    // clear and copy touch the live elements only, their cost follows
+    // state.range(0) elements in a buffer with a fixed capacity of lifetime_capacity
+    constexpr std::size_t lifetime_capacity = 1 << 16;
+
+    template <class T>
+    void clear(benchmark::State &state)
+    {
+        raphia::circ_buffer<T> circ(lifetime_capacity);
+        auto count = static_cast<std::size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                circ.push_back(T());
+            auto start = std::chrono::steady_clock::now();
+            circ.clear();
+            benchmark::ClobberMemory();
+            state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    template <class T>
+    void copy(benchmark::State &state)
+    {
+        raphia::circ_buffer<T> circ(lifetime_capacity);
+        // wrapped, so the copy has two segments
+        for (std::size_t i = 0; i < lifetime_capacity / 2; ++i)
+            circ.push_back(T());
+        circ.pop_front(lifetime_capacity / 2);
+        for (int64_t i = 0; i < state.range(0); ++i)
+            circ.push_back(T());
+        for (auto _ : state)
+        {
+            raphia::circ_buffer<T> copy(circ);
+            benchmark::DoNotOptimize(copy.back());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    using modulo_buffer = raphia::circ_buffer<std::uint32_t>;
+    using pow2_buffer = raphia::circ_buffer_pow2<std::uint32_t>;
+} // namespace
+
+BENCHMARK_TEMPLATE(push_back_overwrite, modulo_buffer);
+BENCHMARK_TEMPLATE(push_back_overwrite, pow2_buffer);
+BENCHMARK_TEMPLATE(push_back_pop_front, modulo_buffer);
+BENCHMARK_TEMPLATE(push_back_pop_front, pow2_buffer);
+BENCHMARK_TEMPLATE(push_front_pop_back, modulo_buffer);
+BENCHMARK_TEMPLATE(push_front_pop_back, pow2_buffer);
+BENCHMARK_TEMPLATE(random_access, modulo_buffer);
+BENCHMARK_TEMPLATE(random_access, pow2_buffer);
+BENCHMARK_TEMPLATE(iterate, modulo_buffer);
+BENCHMARK_TEMPLATE(iterate, pow2_buffer);
+BENCHMARK_TEMPLATE(iterate_segments, modulo_buffer);
+BENCHMARK_TEMPLATE(iterate_segments, pow2_buffer);
+BENCHMARK_TEMPLATE(sort, modulo_buffer);
+BENCHMARK_TEMPLATE(sort, pow2_buffer);
+BENCHMARK_TEMPLATE(stream_per_element, std::uint8_t);
+BENCHMARK_TEMPLATE(stream_bulk, std::uint8_t);
+BENCHMARK_TEMPLATE(stream_per_element, float);
+BENCHMARK_TEMPLATE(stream_bulk, float);
+BENCHMARK_TEMPLATE(stream_overwrite_bulk, std::uint8_t);
+BENCHMARK_TEMPLATE(stream_overwrite_bulk, float);
+BENCHMARK_TEMPLATE(clear, std::uint32_t)->Range(16, 1 << 16)->UseManualTime();
+BENCHMARK_TEMPLATE(clear, std::string)->Range(16, 1 << 16)->UseManualTime();
+BENCHMARK_TEMPLATE(copy, std::uint32_t)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(copy, std::string)->Range(16, 1 << 16);
@@ -0,0 +1,277 @@
+#include "raphia/circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#if defined(BENCH_WITH_BOOST)
+#include <boost/circular_buffer.hpp>
+#endif
+
+// circ_buffer against the usual alternatives, for the value types that
+// behave differently: trivially copyable, owning a heap allocation and large.
+// Run `make bench_json` to get the results as JSON for regression tracking.
+
+namespace
+{
+    constexpr std::size_t capacity = 1024;
+
+    struct large_pod
+    {
+        std::uint64_t data[32];
+    };
+
+    template <class T>
+    T make_value(std::size_t i);
+
+    template <>
+    std::uint32_t make_value<std::uint32_t>(std::size_t i)
+    {
+        return static_cast<std::uint32_t>(i);
+    }
+
+    template <>
+    std::string make_value<std::string>(std::size_t i)
+    {
+        // long enough to defeat the small string optimization
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+
+    template <>
+    large_pod make_value<large_pod>(std::size_t i)
+    {
+        large_pod value;
+        for (auto &d : value.data)
+            d = i;
+        return value;
+    }
+
+    /** container_traits
+     * @brief the operations the benchmarks need, with the overwrite on full
+     * semantics of circ_buffer emulated where the container lacks them
+     */
+    template <class Container>
+    struct container_traits;
+
+    template <class T>
+    struct container_traits<raphia::circ_buffer<T>>
+    {
+        using container = raphia::circ_buffer<T>;
+        static container make(std::size_t count) { return container(count); }
+        static void push(container &c, T value) { c.push_back(std::move(value)); }
+        static void pop(container &c) { c.pop_front(); }
+        static const T &at(const container &c, std::size_t idx) { return c[static_cast<int>(idx)]; }
+        static void grow(container &c, std::size_t count) { c.set_capacity(count); }
+    };
+
+    template <class T>
+    struct container_traits<raphia::circ_buffer_pow2<T>>
+    {
+        using container = raphia::circ_buffer_pow2<T>;
+        static container make(std::size_t count) { return container(count); }
+        static void push(container &c, T value) { c.push_back(std::move(value)); }
+        static void pop(container &c) { c.pop_front(); }
+        static const T &at(const container &c, std::size_t idx) { return c[static_cast<int>(idx)]; }
+        static void grow(container &c, std::size_t count) { c.set_capacity(count); }
+    };
+
+    // a deque has no capacity, it is kept at the same size by hand
+    template <class T>
+    struct bounded_deque
+    {
+        std::deque<T> deque;
+        std::size_t capacity;
+
+        typename std::deque<T>::const_iterator begin() const { return deque.begin(); }
+        typename std::deque<T>::const_iterator end() const { return deque.end(); }
+    };
+
+    template <class T>
+    struct container_traits<bounded_deque<T>>
+    {
+        using container = bounded_deque<T>;
+        static container make(std::size_t count) { return {std::deque<T>(), count}; }
+        static void push(container &c, T value)
+        {
+            if (c.deque.size() == c.capacity)
+                c.deque.pop_front();
+            c.deque.push_back(std::move(value));
+        }
+        static void pop(container &c) { c.deque.pop_front(); }
+        static const T &at(const container &c, std::size_t idx) { return c.deque[idx]; }
+        static void grow(container &c, std::size_t count) { c.capacity = count; }
+    };
+
+#if defined(BENCH_WITH_BOOST)
+    template <class T>
+    struct container_traits<boost::circular_buffer<T>>
+    {
+        using container = boost::circular_buffer<T>;
+        static container make(std::size_t count) { return container(count); }
+        static void push(container &c, T value) { c.push_back(std::move(value)); }
+        static void pop(container &c) { c.pop_front(); }
+        static const T &at(const container &c, std::size_t idx) { return c[idx]; }
+        static void grow(container &c, std::size_t count) { c.set_capacity(count); }
+    };
+#endif
+
+    template <class Container, class T>
+    Container make_filled(std::size_t count)
+    {
+        using traits = container_traits<Container>;
+        auto c = traits::make(count);
+        for (std::size_t i = 0; i < count; ++i)
+            traits::push(c, make_value<T>(i));
+        return c;
+    }
+
+    template <class Container, class T>
+    void steady_state(benchmark::State &state)
+    {
+        using traits = container_traits<Container>;
+        auto c = traits::make(capacity);
+        for (std::size_t i = 0; i < capacity / 2; ++i)
+            traits::push(c, make_value<T>(i));
+        auto value = make_value<T>(0);
+        for (auto _ : state)
+        {
+            traits::push(c, value);
+            traits::pop(c);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Container, class T>
+    void overwrite_churn(benchmark::State &state)
+    {
+        using traits = container_traits<Container>;
+        auto c = make_filled<Container, T>(capacity);
+        auto value = make_value<T>(0);
+        for (auto _ : state)
+            traits::push(c, value);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Container, class T>
+    void iterate(benchmark::State &state)
+    {
+        auto c = make_filled<Container, T>(capacity);
+        for (auto _ : state)
+        {
+            for (auto &v : c)
+                benchmark::DoNotOptimize(&v);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    template <class Container, class T>
+    void random_access(benchmark::State &state)
+    {
+        using traits = container_traits<Container>;
+        auto c = make_filled<Container, T>(capacity);
+        std::size_t idx = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(&traits::at(c, idx));
+            idx = (idx + 97) % capacity;
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Container, class T>
+    void grow(benchmark::State &state)
+    {
+        using traits = container_traits<Container>;
+        for (auto _ : state)
+        {
+            // grow just before the buffer is full, every element is relocated once per step
+            auto c = traits::make(16);
+            std::size_t pushed = 0;
+            for (std::size_t count = 16; count < capacity; count *= 2)
+            {
+                for (; pushed < count - 1; ++pushed)
+                    traits::push(c, make_value<T>(pushed));
+                traits::grow(c, count * 2);
+            }
+            benchmark::DoNotOptimize(&c);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    template <class Container, class T>
+    void copy_construct(benchmark::State &state)
+    {
+        auto c = make_filled<Container, T>(capacity);
+        for (auto _ : state)
+        {
+            Container copy(c);
+            benchmark::DoNotOptimize(&copy);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    template <class Container, class T>
+    void move_construct(benchmark::State &state)
+    {
+        auto c = make_filled<Container, T>(capacity);
+        for (auto _ : state)
+        {
+            Container moved(std::move(c));
+            benchmark::DoNotOptimize(&moved);
+            c = std::move(moved);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    // a queue that must not drop anything: bursts of pushes followed by draining it,
+    // circ_buffer_growing doubles like a vector while std::deque allocates per block
+    template <class Queue, class T>
+    void unbounded_queue(benchmark::State &state)
+    {
+        Queue queue;
+        auto value = make_value<T>(0);
+        auto burst = static_cast<std::size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < burst; ++i)
+                queue.push_back(value);
+            while (!queue.empty())
+            {
+                benchmark::DoNotOptimize(&queue.front());
+                queue.pop_front();
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * burst));
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(unbounded_queue, raphia::circ_buffer_growing<std::uint32_t>, std::uint32_t)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(unbounded_queue, raphia::circ_buffer_growing<std::uint32_t, std::allocator<std::uint32_t>, raphia::pow2_index>, std::uint32_t)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(unbounded_queue, std::deque<std::uint32_t>, std::uint32_t)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(unbounded_queue, raphia::circ_buffer_growing<std::string>, std::string)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(unbounded_queue, std::deque<std::string>, std::string)->Range(64, 64 << 10);
+
+#define BENCH_CONTAINERS(name, T)                                       \
+    BENCHMARK_TEMPLATE(name, raphia::circ_buffer<T>, T);                \
+    BENCHMARK_TEMPLATE(name, raphia::circ_buffer_pow2<T>, T);           \
+    BENCHMARK_TEMPLATE(name, bounded_deque<T>, T);                      \
+    BENCH_BOOST(name, T)
+
+#if defined(BENCH_WITH_BOOST)
+#define BENCH_BOOST(name, T) BENCHMARK_TEMPLATE(name, boost::circular_buffer<T>, T);
+#else
+#define BENCH_BOOST(name, T)
+#endif
+
+#define BENCH_ALL(name)                  \
+    BENCH_CONTAINERS(name, std::uint32_t) \
+    BENCH_CONTAINERS(name, std::string)   \
+    BENCH_CONTAINERS(name, large_pod)
+
+BENCH_ALL(steady_state)
+BENCH_ALL(overwrite_churn)
+BENCH_ALL(iterate)
+BENCH_ALL(random_access)
+BENCH_ALL(grow)
+BENCH_ALL(copy_construct)
+BENCH_ALL(move_construct)
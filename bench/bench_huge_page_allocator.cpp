@@ -0,0 +1,55 @@
+#include "raphia/huge_page_allocator.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#if defined(__linux__)
+
+namespace
+{
+    // a 128 MiB capture window, once on std::allocator and once on pre-faulted transparent huge pages
+    constexpr std::size_t capacity = (std::size_t(128) << 20) / sizeof(std::uint64_t);
+
+    template <class Alloc>
+    using capture_buffer = raphia::circ_buffer<std::uint64_t, Alloc, raphia::pow2_index>;
+
+    /** the first lap through a new ring, with std::allocator every page faults on its first write */
+    template <class Alloc>
+    void first_lap(benchmark::State &state)
+    {
+        for (auto _ : state)
+        {
+            capture_buffer<Alloc> circ(capacity);
+            auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < capacity; ++i)
+                circ.push_back(i);
+            benchmark::DoNotOptimize(circ.back());
+            state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * capacity * sizeof(std::uint64_t)));
+    }
+
+    /** random reads all over the ring, with 4K pages nearly every read misses the TLB */
+    template <class Alloc>
+    void random_reads(benchmark::State &state)
+    {
+        capture_buffer<Alloc> circ(capacity);
+        for (std::uint64_t i = 0; i < capacity; ++i)
+            circ.push_back(i);
+        std::uint64_t pos = 1, sum = 0;
+        for (auto _ : state)
+        {
+            pos = pos * 6364136223846793005ull + 1442695040888963407ull;
+            sum += circ[static_cast<std::size_t>((pos >> 20) & (capacity - 1))];
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    using huge_pages = raphia::huge_page_allocator<std::uint64_t>;
+} // namespace
+
+BENCHMARK_TEMPLATE(first_lap, std::allocator<std::uint64_t>)->UseManualTime()->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(first_lap, huge_pages)->UseManualTime()->Iterations(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(random_reads, std::allocator<std::uint64_t>);
+BENCHMARK_TEMPLATE(random_reads, huge_pages);
+#endif
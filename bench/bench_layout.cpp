@@ -0,0 +1,125 @@
+#include "raphia/circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /** hardware_counter
+     * @brief counts a hardware event for this process and the threads it starts afterwards,
+     * like perf stat does, reads -1 where perf events are unavailable
+     */
+    class hardware_counter
+    {
+    public:
+        explicit hardware_counter(std::uint64_t config) : fd_(-1)
+        {
+#if defined(__linux__)
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = config;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+            (void)config;
+#endif
+        }
+
+        ~hardware_counter()
+        {
+#if defined(__linux__)
+            if (fd_ >= 0)
+                ::close(fd_);
+#endif
+        }
+
+        hardware_counter(const hardware_counter &) = delete;
+        hardware_counter &operator=(const hardware_counter &) = delete;
+
+        void start()
+        {
+#if defined(__linux__)
+            if (fd_ >= 0)
+            {
+                ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        double stop()
+        {
+#if defined(__linux__)
+            std::uint64_t count = 0;
+            if (fd_ >= 0 && ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) == 0 && ::read(fd_, &count, sizeof(count)) == sizeof(count))
+                return static_cast<double>(count);
+#endif
+            return -1;
+        }
+
+    private:
+        int fd_;
+    };
+
+    constexpr std::size_t ops = 1 << 20;
+
+    /** state.range(0) threads work on their own buffer each, with the buffers next to each other
+     * in one array, the way per worker queues usually end up. The packed buffers share cache lines,
+     * so every push and pop invalidates the line of a neighbour, the padded ones don't.
+     * The cache_misses counter is per operation, -1 if perf events are not available. */
+    template <class Buffer, class Alloc>
+    void per_thread_buffers(benchmark::State &state)
+    {
+        auto threads = static_cast<std::size_t>(state.range(0));
+        std::vector<Buffer, Alloc> buffers;
+        buffers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+            buffers.emplace_back(64);
+#if defined(__linux__)
+        hardware_counter misses(PERF_COUNT_HW_CACHE_MISSES);
+#else
+        hardware_counter misses(0);
+#endif
+        double total_misses = 0;
+        for (auto _ : state)
+        {
+            misses.start();
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t)
+                workers.emplace_back([&buffers, t] {
+                    auto &circ = buffers[t];
+                    for (std::size_t i = 0; i < ops; ++i)
+                    {
+                        circ.push_back(i);
+                        circ.pop_front();
+                        // keep the counters in memory, as they are under a lock
+                        benchmark::ClobberMemory();
+                    }
+                    benchmark::DoNotOptimize(circ.size());
+                });
+            for (auto &w : workers)
+                w.join();
+            total_misses += misses.stop();
+        }
+        auto total_ops = static_cast<double>(state.iterations() * threads * ops);
+        state.counters["cache_misses"] = total_misses < 0 ? -1 : total_misses / total_ops;
+        state.SetItemsProcessed(static_cast<int64_t>(total_ops));
+    }
+
+    using packed_buffer = raphia::circ_buffer<std::uint64_t>;
+    using padded_buffer = raphia::circ_buffer_padded<std::uint64_t>;
+} // namespace
+
+BENCHMARK_TEMPLATE(per_thread_buffers, packed_buffer, std::allocator<packed_buffer>)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(per_thread_buffers, padded_buffer, raphia::cache_aligned_allocator<padded_buffer>)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,50 @@
+#include "raphia/mapped_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#if defined(__unix__)
+
+namespace
+{
+    // a flight recorder of 64 byte events, in memory and in a file mapping,
+    // the mapped ring pays for two atomic stores per event and the dirty pages
+    struct event
+    {
+        std::uint64_t sequence;
+        char payload[56];
+    };
+
+    constexpr std::size_t capacity = 64 * 1024;
+
+    void record_heap(benchmark::State &state)
+    {
+        raphia::circ_buffer<event> circ(capacity);
+        event e{};
+        for (auto _ : state)
+        {
+            ++e.sequence;
+            circ.push_back(e);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    void record_mapped(benchmark::State &state)
+    {
+        std::string path = "/tmp/raphia_bench_" + std::to_string(::getpid()) + ".ring";
+        {
+            raphia::mapped_circ_buffer<event> circ(path, capacity);
+            event e{};
+            for (auto _ : state)
+            {
+                ++e.sequence;
+                circ.push_back(e);
+            }
+        }
+        ::unlink(path.c_str());
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+} // namespace
+
+BENCHMARK(record_heap);
+BENCHMARK(record_mapped);
+#endif
@@ -0,0 +1,103 @@
+#include "raphia/mpmc_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t capacity = 1024;
+    constexpr std::uint64_t items = 1 << 18;
+
+    /** circ_buffer behind one global lock, blocking by retrying like the lock-free buffer */
+    class locked_circ_buffer
+    {
+    public:
+        explicit locked_circ_buffer(std::size_t count) : circ_(count) {}
+
+        void push(std::uint64_t value)
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (circ_.size() != circ_.capacity())
+                    {
+                        circ_.push_back(value);
+                        return;
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        void pop(std::uint64_t &value)
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!circ_.empty())
+                    {
+                        value = circ_.front();
+                        circ_.pop_front();
+                        return;
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        raphia::circ_buffer<std::uint64_t> circ_;
+    };
+
+    /** range(0) producers hand items to range(1) consumers */
+    template <class Circ>
+    void fan_in_fan_out(benchmark::State &state)
+    {
+        auto producers = static_cast<std::uint64_t>(state.range(0));
+        auto consumers = static_cast<std::uint64_t>(state.range(1));
+        for (auto _ : state)
+        {
+            Circ circ(capacity);
+            std::vector<std::thread> threads;
+            for (std::uint64_t p = 0; p < producers; ++p)
+                threads.emplace_back([&circ, p, producers]
+                                     {
+                                         for (auto i = p; i < items; i += producers)
+                                             circ.push(i);
+                                     });
+            for (std::uint64_t c = 0; c < consumers; ++c)
+                threads.emplace_back([&circ, c, consumers]
+                                     {
+                                         std::uint64_t value, sum = 0;
+                                         for (auto i = c; i < items; i += consumers)
+                                         {
+                                             circ.pop(value);
+                                             sum += value;
+                                         }
+                                         benchmark::DoNotOptimize(sum);
+                                     });
+            for (auto &t : threads)
+                t.join();
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+    }
+
+    void thread_sweep(benchmark::internal::Benchmark *b)
+    {
+        auto hw = std::max(2u, std::thread::hardware_concurrency());
+        for (unsigned producers = 1; producers <= hw; producers *= 2)
+            for (unsigned consumers = 1; consumers <= hw; consumers *= 2)
+                b->Args({producers, consumers});
+    }
+
+    using mpmc_buffer = raphia::mpmc_circ_buffer<std::uint64_t, std::allocator<std::uint64_t>, raphia::pow2_index>;
+} // namespace
+
+BENCHMARK_TEMPLATE(fan_in_fan_out, locked_circ_buffer)->Apply(thread_sweep)->ArgNames({"producers", "consumers"})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(fan_in_fan_out, mpmc_buffer)->Apply(thread_sweep)->ArgNames({"producers", "consumers"})->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,72 @@
+#include "raphia/record_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // a stream of messages between 16 and 400 bytes, too long for the small string
+    // optimization, pushed into a full ring so every push also retires the oldest message
+    std::vector<std::string> messages()
+    {
+        std::vector<std::string> result;
+        unsigned seed = 1;
+        for (int i = 0; i < 1024; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            result.emplace_back(16 + (seed >> 16) % 384, static_cast<char>('a' + i % 26));
+        }
+        return result;
+    }
+
+    constexpr std::size_t capacity = 4096;
+
+    void push_pop_strings(benchmark::State &state)
+    {
+        auto input = messages();
+        raphia::circ_buffer<std::string> circ(capacity);
+        std::size_t i = 0, bytes = 0;
+        for (auto _ : state)
+        {
+            auto &message = input[i++ % input.size()];
+            circ.push_back(std::string(message.data(), message.size()));
+            if (circ.size() == capacity)
+            {
+                bytes += circ.front().size();
+                benchmark::DoNotOptimize(circ.front().data());
+                circ.pop_front();
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    }
+
+    void push_pop_records(benchmark::State &state)
+    {
+        auto input = messages();
+        // room for about as many messages as the string ring holds
+        raphia::record_circ_buffer<> circ(capacity * 216);
+        std::size_t i = 0, bytes = 0;
+        for (auto _ : state)
+        {
+            auto &message = input[i++ % input.size()];
+            auto record = circ.reserve(message.size());
+            std::memcpy(record.data(), message.data(), message.size());
+            circ.commit(message.size());
+            if (circ.size() == capacity)
+            {
+                auto oldest = circ.peek();
+                bytes += oldest.size();
+                benchmark::DoNotOptimize(oldest.data());
+                circ.pop_front();
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+        state.counters["evicted"] = static_cast<double>(circ.evicted());
+    }
+} // namespace
+
+BENCHMARK(push_pop_strings);
+BENCHMARK(push_pop_records);
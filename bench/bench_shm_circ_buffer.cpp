@@ -0,0 +1,106 @@
+#include "raphia/shm_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+namespace
+{
+    // round trip latency between two processes, a message goes to a forked echo process and back,
+    // once through a pair of shared memory rings and once through a unix domain socket pair
+    struct message
+    {
+        std::int64_t sequence;
+        char payload[56];
+    };
+
+    void ping_pong_shm(benchmark::State &state)
+    {
+        std::string ping_name = "/raphia_bench_ping_" + std::to_string(::getpid());
+        std::string pong_name = "/raphia_bench_pong_" + std::to_string(::getpid());
+        raphia::shm_circ_buffer<message>::remove(ping_name);
+        raphia::shm_circ_buffer<message>::remove(pong_name);
+        {
+            raphia::shm_circ_buffer<message, raphia::pow2_index> ping(ping_name, 64);
+            raphia::shm_circ_buffer<message, raphia::pow2_index> pong(pong_name, 64);
+            auto pid = ::fork();
+            if (pid == 0)
+            {
+                raphia::shm_circ_buffer<message, raphia::pow2_index> in(ping_name);
+                raphia::shm_circ_buffer<message, raphia::pow2_index> out(pong_name);
+                message m;
+                do
+                {
+                    in.pop(m);
+                    out.push(m);
+                } while (m.sequence >= 0);
+                ::_exit(0);
+            }
+            message m{};
+            for (auto _ : state)
+            {
+                ++m.sequence;
+                ping.push(m);
+                pong.pop(m);
+            }
+            m.sequence = -1;
+            ping.push(m);
+            pong.pop(m);
+            ::waitpid(pid, nullptr, 0);
+        }
+        raphia::shm_circ_buffer<message>::remove(ping_name);
+        raphia::shm_circ_buffer<message>::remove(pong_name);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    bool transfer(int fd, message &m, bool send)
+    {
+        auto p = reinterpret_cast<char *>(&m);
+        std::size_t done = 0;
+        while (done < sizeof(m))
+        {
+            auto n = send ? ::write(fd, p + done, sizeof(m) - done) : ::read(fd, p + done, sizeof(m) - done);
+            if (n <= 0)
+                return false;
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    void ping_pong_socket(benchmark::State &state)
+    {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        {
+            state.SkipWithError("socketpair failed");
+            return;
+        }
+        auto pid = ::fork();
+        if (pid == 0)
+        {
+            ::close(fds[0]);
+            message m;
+            while (transfer(fds[1], m, false) && transfer(fds[1], m, true))
+            {
+            }
+            ::_exit(0);
+        }
+        ::close(fds[1]);
+        message m{};
+        for (auto _ : state)
+        {
+            ++m.sequence;
+            transfer(fds[0], m, true);
+            transfer(fds[0], m, false);
+        }
+        ::close(fds[0]);
+        ::waitpid(pid, nullptr, 0);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+} // namespace
+
+BENCHMARK(ping_pong_shm)->UseRealTime();
+BENCHMARK(ping_pong_socket)->UseRealTime();
+#endif
@@ -0,0 +1,79 @@
+#include "raphia/soa_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+namespace
+{
+    // a window of ticks, once as an array of structs and once as columns,
+    // the query only needs the qty field
+    struct tick
+    {
+        std::int64_t timestamp;
+        double price;
+        std::uint32_t qty;
+        std::uint8_t flags;
+    };
+
+    constexpr std::size_t capacity = 1 << 20;
+
+    void qty_sum_aos(benchmark::State &state)
+    {
+        raphia::circ_buffer<tick> circ(capacity);
+        for (std::size_t i = 0; i < capacity + capacity / 3; ++i)
+            circ.push_back(tick{static_cast<std::int64_t>(i), 1.0, static_cast<std::uint32_t>(i & 0xff), 0});
+        for (auto _ : state)
+        {
+            std::uint64_t sum = 0;
+            for (auto &segment : circ.readable_segments())
+                for (auto &t : segment)
+                    sum += t.qty;
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    void qty_sum_soa(benchmark::State &state)
+    {
+        raphia::soa_circ_buffer<std::int64_t, double, std::uint32_t, std::uint8_t> circ(capacity);
+        for (std::size_t i = 0; i < capacity + capacity / 3; ++i)
+            circ.push_back(static_cast<std::int64_t>(i), 1.0, static_cast<std::uint32_t>(i & 0xff), std::uint8_t(0));
+        for (auto _ : state)
+        {
+            std::uint64_t sum = 0;
+            circ.for_each<2>([&sum](std::uint32_t qty) { sum += qty; });
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * capacity));
+    }
+
+    void push_aos(benchmark::State &state)
+    {
+        raphia::circ_buffer<tick> circ(capacity);
+        std::int64_t i = 0;
+        for (auto _ : state)
+        {
+            ++i;
+            circ.push_back(tick{i, 1.0, 1, 0});
+        }
+        benchmark::DoNotOptimize(circ.back());
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    void push_soa(benchmark::State &state)
+    {
+        raphia::soa_circ_buffer<std::int64_t, double, std::uint32_t, std::uint8_t> circ(capacity);
+        std::int64_t i = 0;
+        for (auto _ : state)
+        {
+            ++i;
+            circ.push_back(i, 1.0, 1u, std::uint8_t(0));
+        }
+        benchmark::DoNotOptimize(circ.get<0>(0));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+} // namespace
+
+BENCHMARK(qty_sum_aos);
+BENCHMARK(qty_sum_soa);
+BENCHMARK(push_aos);
+BENCHMARK(push_soa);
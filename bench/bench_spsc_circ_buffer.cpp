@@ -0,0 +1,74 @@
+#include "raphia/circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    constexpr std::size_t capacity = 1024;
+    constexpr std::uint64_t items = 1 << 20;
+
+    /** circ_buffer behind a mutex, the way it had to be shared between threads so far */
+    class locked_circ_buffer
+    {
+    public:
+        explicit locked_circ_buffer(std::size_t count) : circ_(count) {}
+
+        bool try_push(std::uint64_t value)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (circ_.size() == circ_.capacity())
+                return false;
+            circ_.push_back(value);
+            return true;
+        }
+
+        bool try_pop(std::uint64_t &value)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (circ_.empty())
+                return false;
+            value = circ_.front();
+            circ_.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        raphia::circ_buffer<std::uint64_t> circ_;
+    };
+
+    template <class Circ>
+    void producer_consumer(benchmark::State &state)
+    {
+        for (auto _ : state)
+        {
+            Circ circ(capacity);
+            std::thread producer([&circ]
+                                 {
+                                     for (std::uint64_t i = 0; i < items; ++i)
+                                         while (!circ.try_push(i))
+                                             std::this_thread::yield();
+                                 });
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < items; ++i)
+            {
+                std::uint64_t value;
+                while (!circ.try_pop(value))
+                    std::this_thread::yield();
+                sum += value;
+            }
+            producer.join();
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items));
+    }
+
+    using spsc_buffer = raphia::spsc_circ_buffer<std::uint64_t>;
+    using spsc_pow2_buffer = raphia::spsc_circ_buffer<std::uint64_t, std::allocator<std::uint64_t>, raphia::pow2_index>;
+} // namespace
+
+BENCHMARK_TEMPLATE(producer_consumer, locked_circ_buffer)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(producer_consumer, spsc_buffer)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(producer_consumer, spsc_pow2_buffer)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,69 @@
+#include "raphia/static_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Many small per connection rings that are touched in a random order,
+    // the heap backed rings pay an extra pointer chase (and a likely cache
+    // miss) per access. Run under `perf stat -e cache-misses` to see the
+    // miss counts behind the timings.
+    constexpr std::size_t connections = 1 << 14;
+    constexpr std::size_t ring_size = 16;
+
+    struct heap_ring
+    {
+        heap_ring() : circ(ring_size) {}
+        raphia::circ_buffer<std::uint64_t> circ;
+    };
+
+    struct pow2_heap_ring
+    {
+        pow2_heap_ring() : circ(ring_size) {}
+        raphia::circ_buffer_pow2<std::uint64_t> circ;
+    };
+
+    struct static_ring
+    {
+        raphia::static_circ_buffer<std::uint64_t, ring_size> circ;
+    };
+
+    template <class Ring>
+    void scattered_push_back(benchmark::State &state)
+    {
+        auto rings = std::unique_ptr<Ring[]>(new Ring[connections]);
+        std::uint32_t seed = 1;
+        for (auto _ : state)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            auto &circ = rings[seed % connections].circ;
+            circ.push_back(seed);
+            benchmark::DoNotOptimize(circ.front());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    template <class Ring>
+    void local_push_pop(benchmark::State &state)
+    {
+        Ring ring;
+        std::uint64_t value = 0;
+        for (auto _ : state)
+        {
+            ring.circ.push_back(value++);
+            benchmark::DoNotOptimize(ring.circ.back());
+            if (ring.circ.size() > ring_size / 2)
+                ring.circ.pop_front();
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(scattered_push_back, heap_ring);
+BENCHMARK_TEMPLATE(scattered_push_back, pow2_heap_ring);
+BENCHMARK_TEMPLATE(scattered_push_back, static_ring);
+BENCHMARK_TEMPLATE(local_push_pop, heap_ring);
+BENCHMARK_TEMPLATE(local_push_pop, pow2_heap_ring);
+BENCHMARK_TEMPLATE(local_push_pop, static_ring);
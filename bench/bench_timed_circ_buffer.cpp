@@ -0,0 +1,90 @@
+#include "raphia/timed_circ_buffer.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    // one event per microsecond, the ring wrapped, queries ask for the events of a
+    // 100 us window somewhere in the buffer
+    using clock = std::chrono::steady_clock;
+    using micros = std::chrono::microseconds;
+
+    struct event
+    {
+        clock::time_point time;
+        std::uint64_t value;
+    };
+
+    constexpr std::size_t capacity = 1 << 20;
+
+    clock::time_point query_start(std::size_t i)
+    {
+        return clock::time_point(micros(capacity / 2 + (i * 7919) % capacity));
+    }
+
+    void range_scan(benchmark::State &state)
+    {
+        raphia::circ_buffer<event> circ(capacity);
+        for (std::size_t i = 0; i < capacity + capacity / 2; ++i)
+            circ.push_back(event{clock::time_point(micros(i)), i});
+        std::size_t i = 0;
+        for (auto _ : state)
+        {
+            auto t0 = query_start(i++);
+            auto t1 = t0 + micros(100);
+            auto first = std::find_if(circ.cbegin(), circ.cend(), [t0](const event &e) { return !(e.time < t0); });
+            auto last = std::find_if(first, circ.cend(), [t1](const event &e) { return t1 < e.time; });
+            benchmark::DoNotOptimize(last - first);
+        }
+    }
+
+    void range_iterator_bisect(benchmark::State &state)
+    {
+        raphia::circ_buffer<event> circ(capacity);
+        for (std::size_t i = 0; i < capacity + capacity / 2; ++i)
+            circ.push_back(event{clock::time_point(micros(i)), i});
+        std::size_t i = 0;
+        for (auto _ : state)
+        {
+            auto t0 = query_start(i++);
+            auto t1 = t0 + micros(100);
+            auto first = std::partition_point(circ.cbegin(), circ.cend(), [t0](const event &e) { return e.time < t0; });
+            auto last = std::partition_point(first, circ.cend(), [t1](const event &e) { return !(t1 < e.time); });
+            benchmark::DoNotOptimize(last - first);
+        }
+    }
+
+    void range_timed(benchmark::State &state)
+    {
+        raphia::timed_circ_buffer<std::uint64_t> circ(capacity);
+        for (std::size_t i = 0; i < capacity + capacity / 2; ++i)
+            circ.push_back(clock::time_point(micros(i)), i);
+        std::size_t i = 0;
+        for (auto _ : state)
+        {
+            auto t0 = query_start(i++);
+            auto range = circ.range(t0, t0 + micros(100));
+            benchmark::DoNotOptimize(range.second - range.first);
+        }
+    }
+
+    void expire_timed(benchmark::State &state)
+    {
+        // keep the last 100 ms of a 1 event/us stream, expiring once per millisecond
+        raphia::timed_circ_buffer<std::uint64_t> circ(1 << 17);
+        std::size_t now = 0;
+        for (auto _ : state)
+        {
+            for (int i = 0; i < 1000; ++i, ++now)
+                circ.push_back(clock::time_point(micros(now)), now);
+            benchmark::DoNotOptimize(circ.expire_before(clock::time_point(micros(now)) - micros(100000)));
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 1000));
+    }
+} // namespace
+
+BENCHMARK(range_scan);
+BENCHMARK(range_iterator_bisect);
+BENCHMARK(range_timed);
+BENCHMARK(expire_timed);
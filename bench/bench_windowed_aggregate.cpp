@@ -0,0 +1,49 @@
+#include "raphia/windowed_aggregate.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+    // a rolling window of latencies that is queried after every sample,
+    // once recomputed from the buffer and once kept up to date incrementally
+    double next_sample(std::uint32_t &seed)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<double>(seed >> 16);
+    }
+
+    void recompute(benchmark::State &state)
+    {
+        raphia::circ_buffer<double> circ(static_cast<std::size_t>(state.range(0)));
+        std::uint32_t seed = 1;
+        for (auto _ : state)
+        {
+            circ.push_back(next_sample(seed));
+            auto sum = std::accumulate(circ.begin(), circ.end(), 0.0);
+            auto minmax = std::minmax_element(circ.begin(), circ.end());
+            benchmark::DoNotOptimize(sum);
+            benchmark::DoNotOptimize(*minmax.first);
+            benchmark::DoNotOptimize(*minmax.second);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+
+    void incremental(benchmark::State &state)
+    {
+        raphia::windowed_aggregate<double> window(static_cast<std::size_t>(state.range(0)));
+        std::uint32_t seed = 1;
+        for (auto _ : state)
+        {
+            window.push_back(next_sample(seed));
+            benchmark::DoNotOptimize(window.sum());
+            benchmark::DoNotOptimize(window.min());
+            benchmark::DoNotOptimize(window.max());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    }
+} // namespace
+
+BENCHMARK(recompute)->Range(64, 16 << 10);
+BENCHMARK(incremental)->Range(64, 16 << 10);
@@ -0,0 +1,51 @@
+#include "raphia/windowed_histogram.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    // p99 of a rolling latency window, scraped every 100 samples: once by copying
+    // the window out and selecting with nth_element, once from the histogram
+    constexpr int scrape_interval = 100;
+
+    double next_sample(std::uint32_t &seed)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<double>(seed >> 16) + 1;
+    }
+
+    void nth_element_p99(benchmark::State &state)
+    {
+        raphia::circ_buffer<double> circ(static_cast<std::size_t>(state.range(0)));
+        std::vector<double> scratch;
+        std::uint32_t seed = 1;
+        for (auto _ : state)
+        {
+            for (int i = 0; i < scrape_interval; ++i)
+                circ.push_back(next_sample(seed));
+            scratch.assign(circ.begin(), circ.end());
+            auto nth = scratch.begin() + static_cast<std::ptrdiff_t>(scratch.size() * 99 / 100);
+            std::nth_element(scratch.begin(), nth, scratch.end());
+            benchmark::DoNotOptimize(*nth);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * scrape_interval));
+    }
+
+    void histogram_p99(benchmark::State &state)
+    {
+        raphia::windowed_histogram<double> window(static_cast<std::size_t>(state.range(0)), 1, 1 << 16);
+        std::uint32_t seed = 1;
+        for (auto _ : state)
+        {
+            for (int i = 0; i < scrape_interval; ++i)
+                window.push_back(next_sample(seed));
+            benchmark::DoNotOptimize(window.quantile(0.99));
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * scrape_interval));
+    }
+} // namespace
+
+BENCHMARK(nth_element_p99)->Range(1 << 10, 1 << 16);
+BENCHMARK(histogram_p99)->Range(1 << 10, 1 << 16);
@@ -0,0 +1,387 @@
+#ifndef RAPHIA_ASYNC_CIRC_BUFFER_HPP
+#define RAPHIA_ASYNC_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+namespace raphia
+{
+    /** task
+     * @brief fire and forget coroutine for single_thread_executor, it doesn't run
+     * until it is spawned, and its frame is freed when it finishes.
+     * An exception escaping the coroutine terminates the program.
+     */
+    class task
+    {
+    public:
+        struct promise_type
+        {
+            task get_return_object() noexcept { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        task(task &&other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+        task &operator=(task &&) = delete;
+
+        /** ~task
+         * @brief deconstructor, frees the coroutine if it has never been spawned
+         */
+        ~task()
+        {
+            if (handle_)
+                handle_.destroy();
+        }
+
+        /** release
+         * @brief give up ownership of the coroutine, e.g. to resume it
+         */
+        std::coroutine_handle<> release() noexcept
+        {
+            auto handle = handle_;
+            handle_ = nullptr;
+            return handle;
+        }
+
+    private:
+        explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    /** single_thread_executor
+     * @brief runs coroutines on the thread that calls run(), one at a time in the order
+     * they became ready. The ready queue is a growing circ_buffer, so scheduling
+     * doesn't allocate once it has reached its peak size.
+     */
+    class single_thread_executor
+    {
+    public:
+        single_thread_executor() : ready_(64) {}
+
+        single_thread_executor(const single_thread_executor &) = delete;
+        single_thread_executor &operator=(const single_thread_executor &) = delete;
+
+        /** ~single_thread_executor
+         * @brief deconstructor, frees the coroutines that are still waiting to be run
+         */
+        ~single_thread_executor()
+        {
+            for (auto handle : ready_)
+                handle.destroy();
+        }
+
+        /** spawn
+         * @brief schedule a task to start on the next run()
+         */
+        void spawn(task &&t) { post(t.release()); }
+
+        /** post
+         * @brief schedule a suspended coroutine to be resumed by run()
+         */
+        void post(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+        /** run
+         * @brief resume ready coroutines until none is left
+         * @return count of coroutines resumed
+         */
+        std::size_t run()
+        {
+            std::size_t count = 0;
+            while (!ready_.empty())
+            {
+                auto handle = ready_.front();
+                ready_.pop_front();
+                handle.resume();
+                ++count;
+            }
+            return count;
+        }
+
+    private:
+        circ_buffer<std::coroutine_handle<>, std::allocator<std::coroutine_handle<>>, modulo_index, no_stats, geometric_growth> ready_;
+    };
+
+    /** async_circ_buffer
+     * @brief bounded queue between coroutines running on one executor, co_await async_pop()
+     * suspends while the buffer is empty and co_await async_push(a) while it is full.
+     * The opposite operation completes the suspended one on the spot: a push hands its value
+     * straight to the longest waiting consumer, a pop moves the value of the longest waiting
+     * producer into the freed slot, and the waiter is posted to the executor.
+     * Waiters are linked through their awaiters, which live in the coroutine frames,
+     * so suspending doesn't allocate. Not thread safe, every coroutine using the buffer
+     * has to run on the executor.
+     * @tparam Executor anything with post(std::coroutine_handle<>)
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Executor = single_thread_executor, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class async_circ_buffer
+    {
+        struct waiter
+        {
+            waiter *next = nullptr;
+            std::coroutine_handle<> handle;
+        };
+
+        /** waiter_list
+         * @brief FIFO list of suspended awaiters
+         */
+        struct waiter_list
+        {
+            waiter *first = nullptr;
+            waiter *last = nullptr;
+
+            bool empty() const noexcept { return first == nullptr; }
+            void push(waiter *w) noexcept
+            {
+                (last ? last->next : first) = w;
+                last = w;
+            }
+            waiter *pop() noexcept
+            {
+                auto w = first;
+                first = w->next;
+                if (!first)
+                    last = nullptr;
+                return w;
+            }
+        };
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        class pop_awaiter;
+        class push_awaiter;
+
+        /** Constructors **/
+
+        /** async_circ_buffer
+         * @brief constructor
+         * @param count buffer size, rounded according to the index policy
+         * @param executor resumes the waiting coroutines, it has to outlive the buffer
+         * @throw invalid_argument if count is 0
+         */
+        async_circ_buffer(size_type count, Executor &executor, const Alloc &a = Alloc());
+
+        async_circ_buffer(const async_circ_buffer &) = delete;
+        async_circ_buffer &operator=(const async_circ_buffer &) = delete;
+
+        /** Awaitables **/
+
+        /** async_push
+         * @brief co_await adds a value to the end of the buffer, suspends while the buffer is full
+         * @param a value to be added
+         * @return awaitable yielding false if the buffer has been closed
+         */
+        push_awaiter async_push(value_type a);
+
+        /** async_pop
+         * @brief co_await removes the oldest value from the buffer, suspends while the buffer is empty
+         * @return awaitable yielding the value, nullopt if the buffer has been closed and is empty
+         */
+        pop_awaiter async_pop() noexcept;
+
+        /** Shutdown **/
+
+        /** close
+         * @brief reject further pushes and resume every waiting coroutine,
+         * consumers still get the values that are left
+         */
+        void close();
+
+        /** closed
+         * @brief check whether close() has been called
+         */
+        bool closed() const noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of values in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        circ_buffer<T, Alloc, Index> circ_;
+        Executor *executor_;
+        waiter_list consumers_;
+        waiter_list producers_;
+        bool closed_;
+    };
+
+    /** async_circ_buffer::pop_awaiter
+     * @brief awaitable returned by async_pop()
+     */
+    template <class T, class Executor, class Alloc, class Index>
+    class async_circ_buffer<T, Executor, Alloc, Index>::pop_awaiter : waiter
+    {
+    public:
+        bool await_ready() const noexcept { return !circ_->circ_.empty() || circ_->closed_; }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept
+        {
+            this->handle = coroutine;
+            circ_->consumers_.push(this);
+        }
+
+        std::optional<T> await_resume();
+
+    private:
+        friend class async_circ_buffer;
+
+        explicit pop_awaiter(async_circ_buffer &circ) noexcept : circ_(&circ) {}
+
+        async_circ_buffer *circ_;
+        // filled by a push that found this awaiter waiting
+        std::optional<T> value_;
+    };
+
+    /** async_circ_buffer::push_awaiter
+     * @brief awaitable returned by async_push()
+     */
+    template <class T, class Executor, class Alloc, class Index>
+    class async_circ_buffer<T, Executor, Alloc, Index>::push_awaiter : waiter
+    {
+    public:
+        bool await_ready() const noexcept
+        {
+            return circ_->closed_ || !circ_->consumers_.empty() || circ_->circ_.size() < circ_->circ_.capacity();
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept
+        {
+            this->handle = coroutine;
+            circ_->producers_.push(this);
+        }
+
+        bool await_resume();
+
+    private:
+        friend class async_circ_buffer;
+
+        push_awaiter(async_circ_buffer &circ, T &&value) : circ_(&circ), value_(std::move(value)), done_(false) {}
+
+        async_circ_buffer *circ_;
+        T value_;
+        // set by a pop that moved value_ into the buffer
+        bool done_;
+    };
+
+    template <class T, class Executor, class Alloc, class Index>
+    async_circ_buffer<T, Executor, Alloc, Index>::async_circ_buffer(size_type count, Executor &executor, const Alloc &a)
+        : circ_(count, a),
+          executor_(&executor),
+          closed_(false)
+    {
+        if (circ_.capacity() == 0)
+            throw std::invalid_argument("async_circ_buffer: capacity must not be 0");
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    typename async_circ_buffer<T, Executor, Alloc, Index>::push_awaiter
+    async_circ_buffer<T, Executor, Alloc, Index>::async_push(value_type a)
+    {
+        return push_awaiter(*this, std::move(a));
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    typename async_circ_buffer<T, Executor, Alloc, Index>::pop_awaiter
+    async_circ_buffer<T, Executor, Alloc, Index>::async_pop() noexcept
+    {
+        return pop_awaiter(*this);
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    bool async_circ_buffer<T, Executor, Alloc, Index>::push_awaiter::await_resume()
+    {
+        if (done_)
+            return true;
+        auto &circ = *circ_;
+        if (circ.closed_)
+            return false;
+        if (!circ.consumers_.empty())
+        {
+            // consumers only wait on an empty buffer, skip it and hand the value over
+            auto consumer = static_cast<pop_awaiter *>(circ.consumers_.pop());
+            consumer->value_.emplace(std::move(value_));
+            circ.executor_->post(consumer->handle);
+            return true;
+        }
+        circ.circ_.push_back(std::move(value_));
+        return true;
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    std::optional<T> async_circ_buffer<T, Executor, Alloc, Index>::pop_awaiter::await_resume()
+    {
+        if (value_)
+            return std::move(value_);
+        auto &circ = *circ_;
+        if (circ.circ_.empty())
+            return std::nullopt;
+        std::optional<T> value(std::move(circ.circ_.front()));
+        circ.circ_.pop_front();
+        if (!circ.producers_.empty())
+        {
+            // producers only wait on a full buffer, the slot just freed is theirs
+            auto producer = static_cast<push_awaiter *>(circ.producers_.pop());
+            circ.circ_.push_back(std::move(producer->value_));
+            producer->done_ = true;
+            circ.executor_->post(producer->handle);
+        }
+        return value;
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    void async_circ_buffer<T, Executor, Alloc, Index>::close()
+    {
+        closed_ = true;
+        while (!consumers_.empty())
+            executor_->post(consumers_.pop()->handle);
+        while (!producers_.empty())
+            executor_->post(producers_.pop()->handle);
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    bool async_circ_buffer<T, Executor, Alloc, Index>::closed() const noexcept
+    {
+        return closed_;
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    typename async_circ_buffer<T, Executor, Alloc, Index>::size_type
+    async_circ_buffer<T, Executor, Alloc, Index>::size() const noexcept
+    {
+        return circ_.size();
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    bool async_circ_buffer<T, Executor, Alloc, Index>::empty() const noexcept
+    {
+        return circ_.empty();
+    }
+
+    template <class T, class Executor, class Alloc, class Index>
+    typename async_circ_buffer<T, Executor, Alloc, Index>::size_type
+    async_circ_buffer<T, Executor, Alloc, Index>::capacity() const noexcept
+    {
+        return circ_.capacity();
+    }
+} // namespace raphia
+#endif
+#endif
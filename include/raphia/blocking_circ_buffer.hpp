@@ -0,0 +1,348 @@
+#ifndef RAPHIA_BLOCKING_CIRC_BUFFER_HPP
+#define RAPHIA_BLOCKING_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace raphia
+{
+    /** blocking_circ_buffer
+     * @brief bounded queue for a pool of producer and consumer threads on top of circ_buffer,
+     * consumers take up to a batch of elements per wakeup with pop_bulk.
+     * Both sides spin briefly before they park on a condition variable, and a producer
+     * only notifies if a consumer is parked and no wakeup is on its way yet,
+     * so a burst of pushes costs a single wakeup instead of one per element.
+     * Like spsc_circ_buffer it never overwrites, pushing into a full buffer blocks.
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class blocking_circ_buffer
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /** Constructors **/
+
+        /** blocking_circ_buffer
+         * @brief constructor
+         * @param count buffer size, rounded according to the index policy
+         * @throw invalid_argument if count is 0
+         */
+        explicit blocking_circ_buffer(size_type count, const Alloc &a = Alloc());
+
+        blocking_circ_buffer(const blocking_circ_buffer &) = delete;
+        blocking_circ_buffer &operator=(const blocking_circ_buffer &) = delete;
+
+        /** Producers **/
+
+        /** push
+         * @brief add a value to the end of the buffer, waits while the buffer is full
+         * @param a value to be added
+         * @return false if the buffer has been closed
+         */
+        bool push(value_type &&a);
+
+        /** push
+         * @brief add a value to the end of the buffer, waits while the buffer is full
+         * @param a value to be added
+         * @return false if the buffer has been closed
+         */
+        bool push(const value_type &a);
+
+        /** emplace
+         * @brief constructs a new object at the end of the buffer, waits while the buffer is full
+         * @return false if the buffer has been closed
+         */
+        template <class... Args>
+        bool emplace(Args &&...args);
+
+        /** try_push
+         * @brief add a value to the end of the buffer
+         * @param a value to be added
+         * @return false if the buffer is full or has been closed
+         */
+        bool try_push(const value_type &a);
+
+        /** Consumers **/
+
+        /** pop_bulk
+         * @brief move up to max elements out of the buffer, waits while the buffer is empty
+         * @param out output iterator receiving the elements, oldest first
+         * @param max most elements to take
+         * @return count of elements taken, 0 only if the buffer has been closed and is empty
+         */
+        template <class OutputIt>
+        size_type pop_bulk(OutputIt out, size_type max);
+
+        /** pop_bulk
+         * @brief move up to max elements out of the buffer, waits at most timeout while the buffer is empty
+         * @param out output iterator receiving the elements, oldest first
+         * @param max most elements to take
+         * @param timeout longest time to wait for the first element
+         * @return count of elements taken, 0 if the time ran out or the buffer has been closed and is empty
+         */
+        template <class OutputIt, class Rep, class Period>
+        size_type pop_bulk(OutputIt out, size_type max, const std::chrono::duration<Rep, Period> &timeout);
+
+        /** Shutdown **/
+
+        /** close
+         * @brief reject further pushes and wake every waiting thread,
+         * consumers still get the elements that are left
+         */
+        void close();
+
+        /** closed
+         * @brief check whether close() has been called
+         */
+        bool closed() const noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer,
+         * the value may be outdated as soon as it is returned
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty, see size()
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        /** spin
+         * @brief spin with a pause and later yield while ready() is false, without taking the lock
+         */
+        template <class Ready>
+        void spin(Ready ready) const noexcept;
+
+        /** pop_locked
+         * @brief wait with the lock held until an element arrives, the buffer is closed or deadline passes,
+         * then move up to max elements to out and wake the parked producers once
+         */
+        template <class OutputIt>
+        size_type pop_locked(OutputIt out, size_type max, const clock::time_point *deadline);
+
+        /** pushed
+         * @brief update the shared size after a push and wake one parked consumer
+         * if none is on its way yet, unlocks the lock
+         */
+        void pushed(std::unique_lock<std::mutex> &lock);
+
+        static constexpr unsigned spin_limit = 256;
+
+        mutable std::mutex mutex_;
+        std::condition_variable not_empty_;
+        std::condition_variable not_full_;
+        circ_buffer<T, Alloc, Index> circ_;
+        size_type waiting_consumers_;
+        size_type waiting_producers_;
+        // a consumer has been notified and no consumer has taken elements since
+        bool wakeup_pending_;
+        // mirrors of the state guarded by mutex_ for the spinning threads
+        std::atomic<size_type> size_;
+        std::atomic<bool> closed_;
+    };
+
+    template <class T, class Alloc, class Index>
+    blocking_circ_buffer<T, Alloc, Index>::blocking_circ_buffer(size_type count, const Alloc &a)
+        : circ_(count, a),
+          waiting_consumers_(0),
+          waiting_producers_(0),
+          wakeup_pending_(false),
+          size_(0),
+          closed_(false)
+    {
+        if (circ_.capacity() == 0)
+            throw std::invalid_argument("blocking_circ_buffer: capacity must not be 0");
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class Ready>
+    void blocking_circ_buffer<T, Alloc, Index>::spin(Ready ready) const noexcept
+    {
+        for (unsigned attempt = 0; attempt < spin_limit && !ready(); ++attempt)
+        {
+            if (attempt >= 64)
+                std::this_thread::yield();
+#if defined(__SSE2__) || defined(_M_X64)
+            else
+                _mm_pause(); // let the sibling hyperthread run and don't flood the memory order buffer
+#endif
+        }
+    }
+
+    template <class T, class Alloc, class Index>
+    bool blocking_circ_buffer<T, Alloc, Index>::push(value_type &&a)
+    {
+        return emplace(std::move(a));
+    }
+
+    template <class T, class Alloc, class Index>
+    bool blocking_circ_buffer<T, Alloc, Index>::push(const value_type &a)
+    {
+        return emplace(a);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    bool blocking_circ_buffer<T, Alloc, Index>::emplace(Args &&...args)
+    {
+        auto capacity = circ_.capacity();
+        spin([this, capacity] { return size_.load(std::memory_order_relaxed) < capacity || closed_.load(std::memory_order_relaxed); });
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (circ_.size() == capacity && !closed_.load(std::memory_order_relaxed))
+        {
+            ++waiting_producers_;
+            not_full_.wait(lock);
+            --waiting_producers_;
+        }
+        if (closed_.load(std::memory_order_relaxed))
+            return false;
+        circ_.emblace_back(std::forward<Args>(args)...);
+        pushed(lock);
+        return true;
+    }
+
+    template <class T, class Alloc, class Index>
+    bool blocking_circ_buffer<T, Alloc, Index>::try_push(const value_type &a)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (circ_.size() == circ_.capacity() || closed_.load(std::memory_order_relaxed))
+            return false;
+        circ_.push_back(a);
+        pushed(lock);
+        return true;
+    }
+
+    template <class T, class Alloc, class Index>
+    void blocking_circ_buffer<T, Alloc, Index>::pushed(std::unique_lock<std::mutex> &lock)
+    {
+        size_.store(circ_.size(), std::memory_order_relaxed);
+        bool wake = waiting_consumers_ > 0 && !wakeup_pending_;
+        if (wake)
+            wakeup_pending_ = true;
+        lock.unlock();
+        if (wake)
+            not_empty_.notify_one();
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class OutputIt>
+    typename blocking_circ_buffer<T, Alloc, Index>::size_type
+    blocking_circ_buffer<T, Alloc, Index>::pop_bulk(OutputIt out, size_type max)
+    {
+        return pop_locked(out, max, nullptr);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class OutputIt, class Rep, class Period>
+    typename blocking_circ_buffer<T, Alloc, Index>::size_type
+    blocking_circ_buffer<T, Alloc, Index>::pop_bulk(OutputIt out, size_type max, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(timeout);
+        return pop_locked(out, max, &deadline);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class OutputIt>
+    typename blocking_circ_buffer<T, Alloc, Index>::size_type
+    blocking_circ_buffer<T, Alloc, Index>::pop_locked(OutputIt out, size_type max, const clock::time_point *deadline)
+    {
+        if (max == 0)
+            return 0;
+        spin([this] { return size_.load(std::memory_order_relaxed) > 0 || closed_.load(std::memory_order_relaxed); });
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (circ_.empty() && !closed_.load(std::memory_order_relaxed))
+        {
+            ++waiting_consumers_;
+            auto status = std::cv_status::no_timeout;
+            if (deadline)
+                status = not_empty_.wait_until(lock, *deadline);
+            else
+                not_empty_.wait(lock);
+            --waiting_consumers_;
+            if (status == std::cv_status::timeout)
+                break;
+        }
+        size_type count = 0;
+        for (; count < max && !circ_.empty(); ++count)
+        {
+            *out = std::move(circ_.front());
+            ++out;
+            circ_.pop_front();
+        }
+        size_.store(circ_.size(), std::memory_order_relaxed);
+        // whoever takes the elements answers the pending wakeup, even if another consumer
+        // was notified, a spurious wakeup or a timeout on an empty buffer leaves it pending
+        if (count > 0 || closed_.load(std::memory_order_relaxed))
+            wakeup_pending_ = false;
+        // the batch was bigger than max, pass the rest on to the next parked consumer
+        bool wake_consumer = !circ_.empty() && waiting_consumers_ > 0 && !wakeup_pending_;
+        if (wake_consumer)
+            wakeup_pending_ = true;
+        bool wake_producers = count > 0 && waiting_producers_ > 0;
+        lock.unlock();
+        if (wake_consumer)
+            not_empty_.notify_one();
+        if (wake_producers)
+            not_full_.notify_all();
+        return count;
+    }
+
+    template <class T, class Alloc, class Index>
+    void blocking_circ_buffer<T, Alloc, Index>::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_.store(true, std::memory_order_relaxed);
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    template <class T, class Alloc, class Index>
+    bool blocking_circ_buffer<T, Alloc, Index>::closed() const noexcept
+    {
+        return closed_.load(std::memory_order_relaxed);
+    }
+
+    template <class T, class Alloc, class Index>
+    typename blocking_circ_buffer<T, Alloc, Index>::size_type
+    blocking_circ_buffer<T, Alloc, Index>::size() const noexcept
+    {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    template <class T, class Alloc, class Index>
+    bool blocking_circ_buffer<T, Alloc, Index>::empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    template <class T, class Alloc, class Index>
+    typename blocking_circ_buffer<T, Alloc, Index>::size_type
+    blocking_circ_buffer<T, Alloc, Index>::capacity() const noexcept
+    {
+        return circ_.capacity();
+    }
+} // namespace raphia
+#endif
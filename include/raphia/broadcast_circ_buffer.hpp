@@ -0,0 +1,210 @@
+#ifndef RAPHIA_BROADCAST_CIRC_BUFFER_HPP
+#define RAPHIA_BROADCAST_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+
+namespace raphia
+{
+    /** broadcast_circ_buffer
+     * @brief lock-free circular buffer for one writer thread and any number of reader threads,
+     * every reader sees every element. The writer never waits for the readers, it overwrites
+     * the oldest element like circ_buffer, each reader keeps its own cursor and is told how many
+     * elements it lost when the writer lapped it. Readers copy the elements out while the writer
+     * may be overwriting them, so T has to be trivially copyable, a torn copy is detected and
+     * counted as lost.
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class broadcast_circ_buffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "broadcast_circ_buffer: T must be trivially copyable");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        class reader;
+
+        /** Constructors **/
+
+        /** broadcast_circ_buffer
+         * @brief constructor
+         * @param count buffer size, rounded according to the index policy
+         * @throw invalid_argument if count is 0
+         */
+        explicit broadcast_circ_buffer(size_type count, const Alloc &a = Alloc());
+
+        broadcast_circ_buffer(const broadcast_circ_buffer &) = delete;
+        broadcast_circ_buffer &operator=(const broadcast_circ_buffer &) = delete;
+
+        /** Destructor **/
+
+        /** ~broadcast_circ_buffer
+         * @brief deconstructor, no reader may be used afterwards
+         */
+        ~broadcast_circ_buffer();
+
+        /** Writer **/
+
+        /** push
+         * @brief add a value to the end of the buffer, overwriting the oldest element
+         * if the buffer is full, may only be called by the writer
+         * @param a value to be added
+         */
+        void push(const value_type &a) noexcept;
+
+        /** Capacity Methods **/
+
+        /** published
+         * @brief count of elements pushed since construction
+         */
+        size_type published() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity, which is how far a reader may fall behind without losing elements
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        static constexpr std::size_t cache_line = 64;
+
+        // writer side, claimed_ is advanced before a slot is overwritten and tail_ after it,
+        // a reader whose copy overlaps with the overwrite sees the new claimed_ afterwards
+        alignas(cache_line) std::atomic<size_type> claimed_;
+        std::atomic<size_type> tail_;
+
+        // shared, but never written after construction
+        alignas(cache_line) Alloc alloc_;
+        T *buffer_;
+        size_type capacity_;
+    };
+
+    /** broadcast_circ_buffer::reader
+     * @brief cursor of one reader, may only be used by one thread at a time
+     */
+    template <class T, class Alloc, class Index>
+    class broadcast_circ_buffer<T, Alloc, Index>::reader
+    {
+    public:
+        /** reader
+         * @brief constructor, the reader starts behind the last element pushed so far
+         * @param circ buffer to read from, it has to outlive the reader
+         */
+        explicit reader(const broadcast_circ_buffer &circ) noexcept;
+
+        /** try_pop
+         * @brief copy the next element out of the buffer, if the writer has lapped the reader,
+         * the overwritten elements are skipped and added to lost()
+         * @param a receives the element
+         * @return false if the reader has seen every element pushed so far
+         */
+        bool try_pop(value_type &a) noexcept;
+
+        /** available
+         * @brief count of elements pushed but not read yet, can exceed the capacity
+         * if the reader has been lapped, the value may be outdated as soon as it is returned
+         */
+        size_type available() const noexcept;
+
+        /** lost
+         * @brief count of elements skipped so far because the writer overwrote them before they were read
+         */
+        size_type lost() const noexcept;
+
+    private:
+        const broadcast_circ_buffer *circ_;
+        size_type pos_;
+        size_type lost_;
+    };
+
+    template <class T, class Alloc, class Index>
+    broadcast_circ_buffer<T, Alloc, Index>::broadcast_circ_buffer(size_type count, const Alloc &a)
+        : claimed_(0),
+          tail_(0),
+          alloc_(a),
+          buffer_(nullptr),
+          capacity_(Index::round_capacity(count))
+    {
+        if (capacity_ == 0)
+            throw std::invalid_argument("broadcast_circ_buffer: capacity must not be 0");
+        buffer_ = alloc_.allocate(capacity_);
+    }
+
+    template <class T, class Alloc, class Index>
+    broadcast_circ_buffer<T, Alloc, Index>::~broadcast_circ_buffer()
+    {
+        alloc_.deallocate(buffer_, capacity_);
+    }
+
+    template <class T, class Alloc, class Index>
+    void broadcast_circ_buffer<T, Alloc, Index>::push(const value_type &a) noexcept
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        claimed_.store(tail + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&buffer_[Index::index(tail, capacity_)], &a, sizeof(T));
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    template <class T, class Alloc, class Index>
+    typename broadcast_circ_buffer<T, Alloc, Index>::size_type
+    broadcast_circ_buffer<T, Alloc, Index>::published() const noexcept
+    {
+        return tail_.load(std::memory_order_acquire);
+    }
+
+    template <class T, class Alloc, class Index>
+    typename broadcast_circ_buffer<T, Alloc, Index>::size_type
+    broadcast_circ_buffer<T, Alloc, Index>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    template <class T, class Alloc, class Index>
+    broadcast_circ_buffer<T, Alloc, Index>::reader::reader(const broadcast_circ_buffer &circ) noexcept
+        : circ_(&circ),
+          pos_(circ.tail_.load(std::memory_order_acquire)),
+          lost_(0)
+    {
+    }
+
+    template <class T, class Alloc, class Index>
+    bool broadcast_circ_buffer<T, Alloc, Index>::reader::try_pop(value_type &a) noexcept
+    {
+        auto capacity = circ_->capacity_;
+        for (;;)
+        {
+            auto tail = circ_->tail_.load(std::memory_order_acquire);
+            if (tail == pos_)
+                return false;
+            if (tail - pos_ > capacity)
+            {
+                lost_ += tail - capacity - pos_;
+                pos_ = tail - capacity;
+            }
+            std::memcpy(&a, &circ_->buffer_[Index::index(pos_, capacity)], sizeof(T));
+            // like a seqlock, the copy is only valid if the writer hasn't claimed its slot meanwhile
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (circ_->claimed_.load(std::memory_order_relaxed) - pos_ <= capacity)
+            {
+                ++pos_;
+                return true;
+            }
+        }
+    }
+
+    template <class T, class Alloc, class Index>
+    typename broadcast_circ_buffer<T, Alloc, Index>::size_type
+    broadcast_circ_buffer<T, Alloc, Index>::reader::available() const noexcept
+    {
+        return circ_->tail_.load(std::memory_order_acquire) - pos_;
+    }
+
+    template <class T, class Alloc, class Index>
+    typename broadcast_circ_buffer<T, Alloc, Index>::size_type
+    broadcast_circ_buffer<T, Alloc, Index>::reader::lost() const noexcept
+    {
+        return lost_;
+    }
+} // namespace raphia
+#endif
@@ -0,0 +1,443 @@
+#ifndef RAPHIA_CIRC_ALGORITHM_HPP
+#define RAPHIA_CIRC_ALGORITHM_HPP
+#include "circ_buffer.hpp"
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// The algorithms below work on the (at most two) contiguous segments of a buffer
+// instead of going through its iterators. Bytes and floats take SSE2 or AVX2 paths,
+// depending on what the compiler targets (e.g. -mavx2 or -march=native),
+// all other types take plain loops the compiler is free to vectorize.
+#if defined(__AVX2__)
+#define RAPHIA_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define RAPHIA_SIMD_SSE2 1
+#endif
+
+namespace raphia
+{
+    /** sum_type
+     * @brief type the elements of T are summed in, wide integers so bytes don't overflow
+     */
+    template <class T>
+    using sum_type = typename std::conditional<std::is_floating_point<T>::value, T,
+                                               typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>::type;
+
+    namespace detail
+    {
+        inline unsigned first_set_bit(unsigned mask) noexcept
+        {
+#if defined(_MSC_VER)
+            unsigned long idx;
+            _BitScanForward(&idx, mask);
+            return static_cast<unsigned>(idx);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        inline std::size_t count_bits(unsigned mask) noexcept
+        {
+#if defined(_MSC_VER)
+            return __popcnt(mask);
+#else
+            return static_cast<std::size_t>(__builtin_popcount(mask));
+#endif
+        }
+
+        /** Generic segment kernels **/
+
+        template <class T>
+        sum_type<T> sum_segment(const T *first, const T *last) noexcept
+        {
+            return std::accumulate(first, last, sum_type<T>());
+        }
+
+        template <class T>
+        void min_max_segment(const T *first, const T *last, T &lo, T &hi) noexcept
+        {
+            for (; first != last; ++first)
+            {
+                if (*first < lo)
+                    lo = *first;
+                if (hi < *first)
+                    hi = *first;
+            }
+        }
+
+        template <class T>
+        const T *find_segment(const T *first, const T *last, const T &value)
+        {
+            return std::find(first, last, value);
+        }
+
+        template <class T>
+        std::size_t count_segment(const T *first, const T *last, const T &value)
+        {
+            return static_cast<std::size_t>(std::count(first, last, value));
+        }
+
+        /** Byte kernels **/
+
+        inline unsigned long long sum_segment(const unsigned char *first, const unsigned char *last) noexcept
+        {
+            unsigned long long sum = 0;
+#if defined(RAPHIA_SIMD_AVX2)
+            // the sum of absolute differences to zero adds up groups of 8 bytes into 64 bit lanes
+            auto acc = _mm256_setzero_si256();
+            for (; last - first >= 32; first += 32)
+                acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first)), _mm256_setzero_si256()));
+            alignas(32) unsigned long long lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            auto acc16 = _mm_setzero_si128();
+            for (; last - first >= 16; first += 16)
+                acc16 = _mm_add_epi64(acc16, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), _mm_setzero_si128()));
+            alignas(16) unsigned long long lanes16[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes16), acc16);
+            sum += lanes16[0] + lanes16[1];
+#endif
+            for (; first != last; ++first)
+                sum += *first;
+            return sum;
+        }
+
+        inline void min_max_segment(const unsigned char *first, const unsigned char *last, unsigned char &lo, unsigned char &hi) noexcept
+        {
+#if defined(RAPHIA_SIMD_AVX2)
+            if (last - first >= 32)
+            {
+                auto vlo = _mm256_set1_epi8(static_cast<char>(lo));
+                auto vhi = _mm256_set1_epi8(static_cast<char>(hi));
+                for (; last - first >= 32; first += 32)
+                {
+                    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+                    vlo = _mm256_min_epu8(vlo, v);
+                    vhi = _mm256_max_epu8(vhi, v);
+                }
+                alignas(32) unsigned char lanes_lo[32], lanes_hi[32];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(lanes_lo), vlo);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(lanes_hi), vhi);
+                min_max_segment<unsigned char>(lanes_lo, lanes_lo + 32, lo, hi);
+                min_max_segment<unsigned char>(lanes_hi, lanes_hi + 32, lo, hi);
+            }
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            if (last - first >= 16)
+            {
+                auto vlo = _mm_set1_epi8(static_cast<char>(lo));
+                auto vhi = _mm_set1_epi8(static_cast<char>(hi));
+                for (; last - first >= 16; first += 16)
+                {
+                    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                    vlo = _mm_min_epu8(vlo, v);
+                    vhi = _mm_max_epu8(vhi, v);
+                }
+                alignas(16) unsigned char lanes_lo[16], lanes_hi[16];
+                _mm_store_si128(reinterpret_cast<__m128i *>(lanes_lo), vlo);
+                _mm_store_si128(reinterpret_cast<__m128i *>(lanes_hi), vhi);
+                min_max_segment<unsigned char>(lanes_lo, lanes_lo + 16, lo, hi);
+                min_max_segment<unsigned char>(lanes_hi, lanes_hi + 16, lo, hi);
+            }
+#endif
+            min_max_segment<unsigned char>(first, last, lo, hi);
+        }
+
+        inline const unsigned char *find_segment(const unsigned char *first, const unsigned char *last, const unsigned char &value) noexcept
+        {
+#if defined(RAPHIA_SIMD_AVX2)
+            auto needle = _mm256_set1_epi8(static_cast<char>(value));
+            for (; last - first >= 32; first += 32)
+            {
+                auto eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first)), needle);
+                auto mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+                if (mask)
+                    return first + first_set_bit(mask);
+            }
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            auto needle16 = _mm_set1_epi8(static_cast<char>(value));
+            for (; last - first >= 16; first += 16)
+            {
+                auto eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), needle16);
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+                if (mask)
+                    return first + first_set_bit(mask);
+            }
+#endif
+            for (; first != last; ++first)
+                if (*first == value)
+                    return first;
+            return last;
+        }
+
+        inline std::size_t count_segment(const unsigned char *first, const unsigned char *last, const unsigned char &value) noexcept
+        {
+            std::size_t count = 0;
+#if defined(RAPHIA_SIMD_AVX2)
+            // matches are -1, subtracting them counts per lane, the lanes are flushed before they overflow
+            auto needle = _mm256_set1_epi8(static_cast<char>(value));
+            while (last - first >= 32)
+            {
+                auto acc = _mm256_setzero_si256();
+                for (int i = 0; i < 255 && last - first >= 32; ++i, first += 32)
+                    acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first)), needle));
+                alignas(32) unsigned long long lanes[4];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+                count += static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+            }
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            auto needle16 = _mm_set1_epi8(static_cast<char>(value));
+            while (last - first >= 16)
+            {
+                auto acc = _mm_setzero_si128();
+                for (int i = 0; i < 255 && last - first >= 16; ++i, first += 16)
+                    acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), needle16));
+                alignas(16) unsigned long long lanes[2];
+                _mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_sad_epu8(acc, _mm_setzero_si128()));
+                count += static_cast<std::size_t>(lanes[0] + lanes[1]);
+            }
+#endif
+            for (; first != last; ++first)
+                count += *first == value;
+            return count;
+        }
+
+        // equality doesn't care about the signedness, so char and signed char share the byte kernels
+        inline const char *find_segment(const char *first, const char *last, const char &value) noexcept
+        {
+            auto p = reinterpret_cast<const unsigned char *>(first);
+            auto found = find_segment(p, p + (last - first), static_cast<unsigned char>(value));
+            return first + (found - p);
+        }
+
+        inline const signed char *find_segment(const signed char *first, const signed char *last, const signed char &value) noexcept
+        {
+            auto p = reinterpret_cast<const unsigned char *>(first);
+            auto found = find_segment(p, p + (last - first), static_cast<unsigned char>(value));
+            return first + (found - p);
+        }
+
+        inline std::size_t count_segment(const char *first, const char *last, const char &value) noexcept
+        {
+            auto p = reinterpret_cast<const unsigned char *>(first);
+            return count_segment(p, p + (last - first), static_cast<unsigned char>(value));
+        }
+
+        inline std::size_t count_segment(const signed char *first, const signed char *last, const signed char &value) noexcept
+        {
+            auto p = reinterpret_cast<const unsigned char *>(first);
+            return count_segment(p, p + (last - first), static_cast<unsigned char>(value));
+        }
+
+        /** Float kernels, results with NaNs in the buffer are unspecified **/
+
+        inline float sum_segment(const float *first, const float *last) noexcept
+        {
+            float sum = 0;
+#if defined(RAPHIA_SIMD_AVX2)
+            // two accumulators hide the latency of the additions
+            auto acc0 = _mm256_setzero_ps();
+            auto acc1 = _mm256_setzero_ps();
+            for (; last - first >= 16; first += 16)
+            {
+                acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(first));
+                acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(first + 8));
+            }
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+            for (auto lane : lanes)
+                sum += lane;
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            auto acc16 = _mm_setzero_ps();
+            for (; last - first >= 4; first += 4)
+                acc16 = _mm_add_ps(acc16, _mm_loadu_ps(first));
+            alignas(16) float lanes16[4];
+            _mm_store_ps(lanes16, acc16);
+            sum += lanes16[0] + lanes16[1] + lanes16[2] + lanes16[3];
+#endif
+            for (; first != last; ++first)
+                sum += *first;
+            return sum;
+        }
+
+        inline void min_max_segment(const float *first, const float *last, float &lo, float &hi) noexcept
+        {
+#if defined(RAPHIA_SIMD_AVX2)
+            if (last - first >= 8)
+            {
+                auto vlo = _mm256_set1_ps(lo);
+                auto vhi = _mm256_set1_ps(hi);
+                for (; last - first >= 8; first += 8)
+                {
+                    auto v = _mm256_loadu_ps(first);
+                    vlo = _mm256_min_ps(vlo, v);
+                    vhi = _mm256_max_ps(vhi, v);
+                }
+                alignas(32) float lanes_lo[8], lanes_hi[8];
+                _mm256_store_ps(lanes_lo, vlo);
+                _mm256_store_ps(lanes_hi, vhi);
+                min_max_segment<float>(lanes_lo, lanes_lo + 8, lo, hi);
+                min_max_segment<float>(lanes_hi, lanes_hi + 8, lo, hi);
+            }
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            if (last - first >= 4)
+            {
+                auto vlo = _mm_set1_ps(lo);
+                auto vhi = _mm_set1_ps(hi);
+                for (; last - first >= 4; first += 4)
+                {
+                    auto v = _mm_loadu_ps(first);
+                    vlo = _mm_min_ps(vlo, v);
+                    vhi = _mm_max_ps(vhi, v);
+                }
+                alignas(16) float lanes_lo[4], lanes_hi[4];
+                _mm_store_ps(lanes_lo, vlo);
+                _mm_store_ps(lanes_hi, vhi);
+                min_max_segment<float>(lanes_lo, lanes_lo + 4, lo, hi);
+                min_max_segment<float>(lanes_hi, lanes_hi + 4, lo, hi);
+            }
+#endif
+            min_max_segment<float>(first, last, lo, hi);
+        }
+
+        inline const float *find_segment(const float *first, const float *last, const float &value) noexcept
+        {
+#if defined(RAPHIA_SIMD_AVX2)
+            auto needle = _mm256_set1_ps(value);
+            for (; last - first >= 8; first += 8)
+            {
+                auto mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(first), needle, _CMP_EQ_OQ)));
+                if (mask)
+                    return first + first_set_bit(mask);
+            }
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            auto needle4 = _mm_set1_ps(value);
+            for (; last - first >= 4; first += 4)
+            {
+                auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(first), needle4)));
+                if (mask)
+                    return first + first_set_bit(mask);
+            }
+#endif
+            for (; first != last; ++first)
+                if (*first == value)
+                    return first;
+            return last;
+        }
+
+        inline std::size_t count_segment(const float *first, const float *last, const float &value) noexcept
+        {
+            std::size_t count = 0;
+#if defined(RAPHIA_SIMD_AVX2)
+            auto needle = _mm256_set1_ps(value);
+            for (; last - first >= 8; first += 8)
+                count += count_bits(static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(first), needle, _CMP_EQ_OQ))));
+#endif
+#if defined(RAPHIA_SIMD_SSE2)
+            auto needle4 = _mm_set1_ps(value);
+            for (; last - first >= 4; first += 4)
+                count += count_bits(static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(first), needle4))));
+#endif
+            for (; first != last; ++first)
+                count += *first == value;
+            return count;
+        }
+    } // namespace detail
+
+    /** sum
+     * @brief sum of all elements, floating point elements are summed in several lanes,
+     * so the result may differ in rounding from a sequential sum
+     * @param circ circ_buffer or static_circ_buffer of an arithmetic type
+     * @return the sum in sum_type<T>
+     */
+    template <class Circ>
+    sum_type<typename Circ::value_type> sum(const Circ &circ) noexcept
+    {
+        using T = typename Circ::value_type;
+        static_assert(std::is_arithmetic<T>::value, "raphia::sum requires an arithmetic type");
+        sum_type<T> result = sum_type<T>();
+        for (auto &segment : circ.readable_segments())
+            result += detail::sum_segment(segment.data(), segment.data() + segment.size());
+        return result;
+    }
+
+    /** min_max
+     * @brief smallest and largest element
+     * @param circ circ_buffer or static_circ_buffer of an arithmetic type
+     * @return pair of the smallest and the largest element
+     * @throw underflow_error if the buffer is empty
+     */
+    template <class Circ>
+    std::pair<typename Circ::value_type, typename Circ::value_type> min_max(const Circ &circ)
+    {
+        using T = typename Circ::value_type;
+        static_assert(std::is_arithmetic<T>::value, "raphia::min_max requires an arithmetic type");
+        if (circ.empty())
+            throw std::underflow_error("circ_buffer: tried to access empty container");
+        auto lo = circ.front();
+        auto hi = lo;
+        for (auto &segment : circ.readable_segments())
+            detail::min_max_segment(segment.data(), segment.data() + segment.size(), lo, hi);
+        return {lo, hi};
+    }
+
+    /** find
+     * @brief first element equal to value, e.g. the next delimiter in a byte stream
+     * @param circ buffer to search
+     * @param value value to search for
+     * @param pos number of elements at the front to skip, e.g. the part searched before
+     * @return iterator to the element, or cend() if there is none
+     */
+    template <class Circ>
+    typename Circ::const_iterator find(const Circ &circ, const typename Circ::value_type &value, typename Circ::size_type pos = 0)
+    {
+        typename Circ::size_type offset = 0;
+        for (auto &segment : circ.readable_segments())
+        {
+            auto first = segment.data();
+            auto last = segment.data() + segment.size();
+            if (pos >= segment.size())
+            {
+                pos -= segment.size();
+                offset += segment.size();
+                continue;
+            }
+            auto found = detail::find_segment(first + pos, last, value);
+            if (found != last)
+                return circ.cbegin() + static_cast<std::ptrdiff_t>(offset + static_cast<typename Circ::size_type>(found - first));
+            pos = 0;
+            offset += segment.size();
+        }
+        return circ.cend();
+    }
+
+    /** count
+     * @brief number of elements equal to value
+     */
+    template <class Circ>
+    typename Circ::size_type count(const Circ &circ, const typename Circ::value_type &value)
+    {
+        typename Circ::size_type result = 0;
+        for (auto &segment : circ.readable_segments())
+            result += detail::count_segment(segment.data(), segment.data() + segment.size(), value);
+        return result;
+    }
+} // namespace raphia
+#endif
@@ -2,56 +2,349 @@
 #define RAPHIA_CIRC_BUFFER_HPP
 #include <stdexcept>
 #include <memory>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <iterator>
+#include <type_traits>
 
 namespace raphia
 {
+    /** modulo_index
+     * @brief index policy that maps the free running counters onto the buffer
+     * with an integer division, any capacity is allowed
+     */
+    struct modulo_index
+    {
+        /** counters may not wrap around zero, since 2^N is no multiple of the capacity */
+        static constexpr bool wraps = false;
+
+        static std::size_t round_capacity(std::size_t count) noexcept { return count; }
+        static std::size_t index(std::size_t pos, std::size_t capacity) noexcept { return pos % capacity; }
+        /** maps a slot position below 2 * capacity without a division */
+        static std::size_t wrap(std::size_t pos, std::size_t capacity) noexcept { return pos < capacity ? pos : pos - capacity; }
+    };
+
+    /** pow2_index
+     * @brief index policy that rounds the capacity up to the next power of two
+     * and maps the free running counters onto the buffer with a bitmask
+     */
+    struct pow2_index
+    {
+        /** counters may wrap around zero, the mask keeps them consistent */
+        static constexpr bool wraps = true;
+
+        static std::size_t round_capacity(std::size_t count);
+        static std::size_t index(std::size_t pos, std::size_t capacity) noexcept { return pos & (capacity - 1); }
+        static std::size_t wrap(std::size_t pos, std::size_t capacity) noexcept { return pos & (capacity - 1); }
+    };
+
+    inline std::size_t pow2_index::round_capacity(std::size_t count)
+    {
+        if (count > (static_cast<std::size_t>(-1) >> 1) + 1)
+            throw std::length_error("circ_buffer: capacity exceeds the largest power of two");
+        std::size_t capacity = count ? 1 : 0;
+        while (capacity < count)
+            capacity <<= 1;
+        return capacity;
+    }
+
+    /** circ_buffer_stats
+     * @brief snapshot of the counters kept by a stats policy, all counts are elements
+     */
+    struct circ_buffer_stats
+    {
+        std::size_t pushes = 0;
+        std::size_t pops = 0;
+        /** elements dropped from the front because push_back hit a full buffer
+         * or set_capacity shrank the buffer below its size */
+        std::size_t overwrites_front = 0;
+        /** elements dropped from the back because push_front hit a full buffer */
+        std::size_t overwrites_back = 0;
+        std::size_t peak_size = 0;
+        std::size_t set_capacity_calls = 0;
+    };
+
+    /** no_stats
+     * @brief stats policy that counts nothing, the calls compile to nothing
+     * and the empty base takes no space
+     */
+    struct no_stats
+    {
+        void on_push(std::size_t, std::size_t) noexcept {}
+        void on_pop(std::size_t) noexcept {}
+        void on_overwrite_front(std::size_t) noexcept {}
+        void on_overwrite_back(std::size_t) noexcept {}
+        void on_set_capacity() noexcept {}
+        circ_buffer_stats snapshot() const noexcept { return circ_buffer_stats(); }
+        void reset() noexcept {}
+    };
+
+    /** counting_stats
+     * @brief stats policy that counts pushes, pops, overwrites, set_capacity calls
+     * and remembers the peak size
+     */
+    struct counting_stats
+    {
+        void on_push(std::size_t count, std::size_t size) noexcept
+        {
+            stats_.pushes += count;
+            if (size > stats_.peak_size)
+                stats_.peak_size = size;
+        }
+        void on_pop(std::size_t count) noexcept { stats_.pops += count; }
+        void on_overwrite_front(std::size_t count) noexcept { stats_.overwrites_front += count; }
+        void on_overwrite_back(std::size_t count) noexcept { stats_.overwrites_back += count; }
+        void on_set_capacity() noexcept { ++stats_.set_capacity_calls; }
+        circ_buffer_stats snapshot() const noexcept { return stats_; }
+        void reset() noexcept { stats_ = circ_buffer_stats(); }
+
+    private:
+        circ_buffer_stats stats_;
+    };
+
+    /** no_growth
+     * @brief growth policy that keeps the capacity, a full buffer overwrites
+     * the element at the other end
+     */
+    struct no_growth
+    {
+        static constexpr bool grows = false;
+
+        static std::size_t next_capacity(std::size_t capacity) noexcept { return capacity; }
+    };
+
+    /** geometric_growth
+     * @brief growth policy that doubles the capacity of a full buffer instead of overwriting,
+     * which keeps pushes amortized O(1)
+     */
+    struct geometric_growth
+    {
+        static constexpr bool grows = true;
+
+        static std::size_t next_capacity(std::size_t capacity) noexcept { return capacity < 8 ? 8 : 2 * capacity; }
+    };
+
+    /** packed_layout
+     * @brief layout policy that keeps every member of circ_buffer in one cache line,
+     * ideal as long as a single thread uses the buffer
+     */
+    struct packed_layout
+    {
+        static constexpr std::size_t alignment = alignof(std::size_t);
+    };
+
+    /** padded_layout
+     * @brief layout policy that puts head_ and tail_ on cache lines of their own,
+     * so threads working on either end under external synchronization
+     * don't invalidate each other's line. Objects of such a buffer are over-aligned,
+     * allocate them with cache_aligned_allocator rather than new.
+     * @tparam Line cache line size, 128 also covers the adjacent line prefetcher of x86
+     */
+    template <std::size_t Line = 64>
+    struct padded_layout
+    {
+        static_assert(Line && (Line & (Line - 1)) == 0, "padded_layout: Line must be a power of two");
+        static constexpr std::size_t alignment = Line;
+    };
+
+    /** cache_aligned_allocator
+     * @brief allocator whose blocks start at a cache line boundary, so a buffer shares
+     * no line with the data in front of it
+     * @tparam Align alignment in bytes, a power of two
+     */
+    template <class T, std::size_t Align = 64>
+    class cache_aligned_allocator
+    {
+        static_assert(Align && (Align & (Align - 1)) == 0, "cache_aligned_allocator: Align must be a power of two");
+
+    public:
+        using value_type = T;
+
+        template <class U>
+        struct rebind
+        {
+            using other = cache_aligned_allocator<U, Align>;
+        };
+
+        cache_aligned_allocator() noexcept = default;
+
+        template <class U>
+        cache_aligned_allocator(const cache_aligned_allocator<U, Align> &) noexcept
+        {
+        }
+
+        /** allocate
+         * @brief allocate room for count elements at an Align boundary
+         * @throw bad_alloc if the memory is exhausted or the size overflows
+         */
+        T *allocate(std::size_t count);
+
+        /** deallocate
+         * @brief release a block returned by allocate
+         */
+        void deallocate(T *p, std::size_t count) noexcept;
+
+    private:
+        static constexpr std::size_t alignment = Align > alignof(T) ? Align : alignof(T);
+    };
+
+    template <class T, std::size_t Align>
+    T *cache_aligned_allocator<T, Align>::allocate(std::size_t count)
+    {
+        if (count == 0)
+            return nullptr;
+        if (count > (static_cast<std::size_t>(-1) - alignment - sizeof(void *)) / sizeof(T))
+            throw std::bad_alloc();
+        // over-allocate and keep the pointer operator new returned right in front of the block
+        auto raw = static_cast<char *>(::operator new(count * sizeof(T) + alignment + sizeof(void *)));
+        auto addr = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *) + alignment - 1) & ~(alignment - 1);
+        auto p = reinterpret_cast<char *>(addr);
+        std::memcpy(p - sizeof(void *), &raw, sizeof(void *));
+        return reinterpret_cast<T *>(p);
+    }
+
+    template <class T, std::size_t Align>
+    void cache_aligned_allocator<T, Align>::deallocate(T *p, std::size_t) noexcept
+    {
+        if (!p)
+            return;
+        void *raw;
+        std::memcpy(&raw, reinterpret_cast<char *>(p) - sizeof(void *), sizeof(void *));
+        ::operator delete(raw);
+    }
+
+    template <class T, class U, std::size_t Align>
+    bool operator==(const cache_aligned_allocator<T, Align> &, const cache_aligned_allocator<U, Align> &) noexcept
+    {
+        return true;
+    }
+
+    template <class T, class U, std::size_t Align>
+    bool operator!=(const cache_aligned_allocator<T, Align> &, const cache_aligned_allocator<U, Align> &) noexcept
+    {
+        return false;
+    }
+
+    /** span
+     * @brief non owning view of a contiguous range of elements
+     */
+    template <class T>
+    class span
+    {
+    public:
+        using element_type = T;
+        using value_type = typename std::remove_cv<T>::type;
+        using size_type = std::size_t;
+        using pointer = T *;
+        using reference = T &;
+        using iterator = T *;
+
+        span() noexcept : data_(nullptr), size_(0) {}
+        span(pointer data, size_type size) noexcept : data_(data), size_(size) {}
+
+        pointer data() const noexcept { return data_; }
+        size_type size() const noexcept { return size_; }
+        size_type size_bytes() const noexcept { return size_ * sizeof(T); }
+        bool empty() const noexcept { return size_ == 0; }
+        iterator begin() const noexcept { return data_; }
+        iterator end() const noexcept { return data_ + size_; }
+        reference operator[](size_type idx) const noexcept { return data_[idx]; }
+
+    private:
+        pointer data_;
+        size_type size_;
+    };
+
     /** circ_buffer
      * @brief STL compatible container with circular buffer logic
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     * @tparam Stats policy counting the operations, see no_stats and counting_stats
+     * @tparam Growth policy deciding whether a full buffer overwrites or grows, see no_growth and geometric_growth
+     * @tparam Layout policy placing the counters in memory, see packed_layout and padded_layout
      */
-    template <class T, class Alloc = std::allocator<T>>
-    class circ_buffer
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index, class Stats = no_stats, class Growth = no_growth, class Layout = packed_layout>
+    class circ_buffer : private Stats
     {
     public:
+        using size_type = std::size_t;
+
         /** basic_iterator
-         * @brief bidirectional iterator
+         * @brief random access iterator, it remembers the slot of the first element
+         * so dereferencing it needs no division
          */
         template <class Container, class ValueType>
         struct basic_iterator
         {
-            using iterator_category = std::forward_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
             using difference_type = std::ptrdiff_t;
-            using value_type = ValueType;
-            using pointer = value_type *;
-            using reference = value_type &;
+            using value_type = typename std::remove_const<ValueType>::type;
+            using pointer = ValueType *;
+            using reference = ValueType &;
             using container = Container;
 
-            basic_iterator(difference_type offset, container &circ_buffer)
-                : offset_(offset), circ_(circ_buffer) {}
+            basic_iterator() noexcept
+                : offset_(0), first_(0), circ_(nullptr) {}
+
+            basic_iterator(difference_type offset, container &circ_buffer) noexcept
+                : offset_(offset),
+                  first_(circ_buffer.capacity_ ? Index::index(circ_buffer.head_, circ_buffer.capacity_) : 0),
+                  circ_(&circ_buffer) {}
+
+            /** basic_iterator
+             * @brief converts an iterator into a const_iterator
+             */
+            template <class C, class V, class = typename std::enable_if<std::is_convertible<V *, ValueType *>::value>::type>
+            basic_iterator(const basic_iterator<C, V> &it) noexcept
+                : offset_(it.offset_), first_(it.first_), circ_(it.circ_) {}
 
             reference operator*() const;
-            pointer operator->();
+            pointer operator->() const;
+            reference operator[](difference_type n) const;
             basic_iterator &operator++();
             basic_iterator operator++(int);
             basic_iterator &operator--();
             basic_iterator operator--(int);
+            basic_iterator &operator+=(difference_type n);
+            basic_iterator &operator-=(difference_type n);
+            basic_iterator operator+(difference_type n) const;
+            basic_iterator operator-(difference_type n) const;
             typename basic_iterator::difference_type operator-(const basic_iterator &it) const;
 
+            /** segment
+             * @brief the contiguous elements from this iterator up to last
+             * or up to the end of the buffer, whatever comes first
+             */
+            span<ValueType> segment(const basic_iterator &last) const;
+
+            friend basic_iterator operator+(difference_type n, const basic_iterator &it) { return it + n; }
             friend bool operator==(const basic_iterator &a, const basic_iterator &b) { return a.offset_ == b.offset_; };
             friend bool operator!=(const basic_iterator &a, const basic_iterator &b) { return a.offset_ != b.offset_; };
+            friend bool operator<(const basic_iterator &a, const basic_iterator &b) { return a.offset_ < b.offset_; };
+            friend bool operator>(const basic_iterator &a, const basic_iterator &b) { return a.offset_ > b.offset_; };
+            friend bool operator<=(const basic_iterator &a, const basic_iterator &b) { return a.offset_ <= b.offset_; };
+            friend bool operator>=(const basic_iterator &a, const basic_iterator &b) { return a.offset_ >= b.offset_; };
 
         private:
+            template <class, class>
+            friend struct basic_iterator;
+
             difference_type offset_;
-            container &circ_;
+            size_type first_;
+            container *circ_;
         };
 
         using value_type = T;
         using reference = value_type &;
         using const_reference = const value_type &;
-        using size_type = std::size_t;
-        using iterator = basic_iterator<circ_buffer<T, Alloc>, T>;
-        using const_iterator = basic_iterator<const circ_buffer<T, Alloc>, const T>;
+        using iterator = basic_iterator<circ_buffer<T, Alloc, Index, Stats, Growth, Layout>, T>;
+        using const_iterator = basic_iterator<const circ_buffer<T, Alloc, Index, Stats, Growth, Layout>, const T>;
         using reverse_iterator = std::reverse_iterator<iterator>;
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using segments = std::array<span<T>, 2>;
+        using const_segments = std::array<span<const T>, 2>;
 
         /** Constructors **/
 
@@ -94,12 +387,12 @@ namespace raphia
         /** operator=
          * @brief copy operator
          */
-        circ_buffer<T, Alloc> &operator=(const circ_buffer &);
+        circ_buffer<T, Alloc, Index, Stats, Growth, Layout> &operator=(const circ_buffer &);
 
         /** operator=
          * @brief move operator
          */
-        circ_buffer<T, Alloc> &operator=(circ_buffer &&) noexcept;
+        circ_buffer<T, Alloc, Index, Stats, Growth, Layout> &operator=(circ_buffer &&) noexcept;
 
         /** Iterators **/
 
@@ -115,6 +408,18 @@ namespace raphia
          */
         iterator end() noexcept;
 
+        /** begin
+         * @brief retrieves a constant iterator the first element
+         * @return constant iterator to the first element
+         */
+        const_iterator begin() const noexcept;
+
+        /** end
+         * @brief retrieves a constant iterator the last element
+         * @return constant iterator to the last element
+         */
+        const_iterator end() const noexcept;
+
         /** cbegin
          * @brief retrieves a constant iterator the first element
          * @return constant iterator to the first element
@@ -128,26 +433,26 @@ namespace raphia
         const_iterator cend() const noexcept;
 
         /** rbegin
-         * @brief retrieves a reverse iterator the first element
-         * @return reverse iterator to the first element
+         * @brief retrieves a reverse iterator to the last element
+         * @return reverse iterator to the last element
          */
         reverse_iterator rbegin() noexcept;
 
         /** rend
-         * @brief retrieves a reverse iterator the last element
-         * @return reverse iterator to the last element
+         * @brief retrieves a reverse iterator in front of the first element
+         * @return reverse iterator in front of the first element
          */
         reverse_iterator rend() noexcept;
 
         /** crbegin
-         * @brief retrieves a constant reverse iterator the first element
-         * @return constant reverse iterator to the first element
+         * @brief retrieves a constant reverse iterator to the last element
+         * @return constant reverse iterator to the last element
          */
         const_reverse_iterator crbegin() const noexcept;
 
         /** crend
-         * @brief retrieves a constant reverse iterator the last element
-         * @return constant reverse iterator to the last element
+         * @brief retrieves a constant reverse iterator in front of the first element
+         * @return constant reverse iterator in front of the first element
          */
         const_reverse_iterator crend() const noexcept;
 
@@ -191,6 +496,31 @@ namespace raphia
          */
         void pop_back();
 
+        /** push_back
+         * @brief add a range of values to the end of the circular buffer,
+         * if the buffer runs out of space, the first elements will be overwritten
+         * just like with repeated calls to push_back(value)
+         * @param first begin of the range
+         * @param last end of the range
+         */
+        template <class Iter, class = typename std::iterator_traits<Iter>::iterator_category>
+        void push_back(Iter first, Iter last);
+
+        /** pop_front
+         * @brief remove elements from the front of the buffer
+         * @param count number of elements to remove, limited to the buffer size
+         */
+        void pop_front(size_type count) noexcept;
+
+        /** copy_out
+         * @brief copy elements from the front of the buffer without removing them
+         * @param dest destination of the elements
+         * @param count number of elements to copy, limited to the buffer size
+         * @return iterator behind the last copied element
+         */
+        template <class OutIter>
+        OutIter copy_out(OutIter dest, size_type count) const;
+
         /** emblace_front
          * @brief constructs a new object at the front of the buffer
          * @returns a reference to the newly constructed object
@@ -211,10 +541,22 @@ namespace raphia
         void clear() noexcept;
 
         /** set_capacity
-         * @brief set_capacity the buffer
+         * @brief set_capacity the buffer, the capacity is rounded according to the index policy,
+         * if it is below the size, the first elements are removed
          */
         void set_capacity(size_type);
 
+        /** reserve
+         * @brief grow the capacity to at least count, never shrinks it
+         * @param count minimum capacity, rounded according to the index policy
+         */
+        void reserve(size_type count);
+
+        /** shrink_to_fit
+         * @brief reduce the capacity to the size, rounded according to the index policy
+         */
+        void shrink_to_fit();
+
         /** Capacity Methods **/
 
         /** size
@@ -235,6 +577,19 @@ namespace raphia
          */
         size_type capacity() const noexcept;
 
+        /** Statistics **/
+
+        /** stats
+         * @brief snapshot of the counters of the stats policy, all zero with no_stats
+         * @return the counters since construction or the last reset_stats()
+         */
+        circ_buffer_stats stats() const noexcept;
+
+        /** reset_stats
+         * @brief reset the counters of the stats policy
+         */
+        void reset_stats() noexcept;
+
         /** Accessors **/
 
         /** front
@@ -279,149 +634,443 @@ namespace raphia
          */
         const_reference &at(int idx) const;
 
+        /** Segments **/
+
+        /** array_one
+         * @brief the first contiguous part of the elements, starting with the first element
+         * @return span of the first part, empty if the buffer is empty
+         */
+        span<T> array_one() noexcept;
+
+        /** array_one
+         * @brief the first contiguous part of the elements, starting with the first element
+         * @return span of the first part, empty if the buffer is empty
+         */
+        span<const T> array_one() const noexcept;
+
+        /** array_two
+         * @brief the second contiguous part of the elements, starting at the beginning of the buffer
+         * @return span of the second part, empty if the elements don't wrap around
+         */
+        span<T> array_two() noexcept;
+
+        /** array_two
+         * @brief the second contiguous part of the elements, starting at the beginning of the buffer
+         * @return span of the second part, empty if the elements don't wrap around
+         */
+        span<const T> array_two() const noexcept;
+
+        /** readable_segments
+         * @brief all elements as at most two contiguous parts, see array_one() and array_two()
+         */
+        segments readable_segments() noexcept;
+
+        /** readable_segments
+         * @brief all elements as at most two contiguous parts, see array_one() and array_two()
+         */
+        const_segments readable_segments() const noexcept;
+
+        /** prepare
+         * @brief get the free slots behind the last element as at most two contiguous parts,
+         * so they can be filled directly (e.g. with readv). Only for trivially copyable types.
+         * @param count number of slots wanted, less are returned if the buffer has less free slots
+         * @return writable segments, call commit() afterwards to add the elements
+         */
+        segments prepare(size_type count) noexcept;
+
+        /** commit
+         * @brief add elements that have been written to the segments returned by prepare()
+         * @param count number of elements to add, limited to the free slots
+         */
+        void commit(size_type count) noexcept;
+
+        /** consume
+         * @brief remove elements from the front, e.g. after they have been written with writev
+         * @param count number of elements to remove, limited to the buffer size
+         */
+        void consume(size_type count) noexcept;
+
     private:
+        /** prev_head
+         * @brief counter position in front of the head, rebases the counters
+         * first if the index policy can't handle a wrap around zero
+         */
+        size_type prev_head() noexcept;
+
+        /** grow_back
+         * @brief constructs a new object at the back of a full buffer after growing it,
+         * the object is constructed first, so args may refer to an element of the buffer
+         */
+        template <class... Args>
+        reference grow_back(Args &&...args);
+
+        /** grow_front
+         * @brief constructs a new object at the front of a full buffer after growing it
+         */
+        template <class... Args>
+        reference grow_front(Args &&...args);
+
+        /** reallocate
+         * @brief move the elements into a new buffer with the given capacity, which must hold
+         * all but the first skip of them, the skipped ones are destroyed
+         */
+        void reallocate(size_type new_capacity, size_type skip = 0);
+
+        /** relocate
+         * @brief move the elements behind the first skip to the start of new_buffer and take it over,
+         * leaves the buffer untouched if a move throws
+         */
+        void relocate(T *new_buffer, size_type new_capacity, size_type skip = 0);
+
+        /** move_chunk
+         * @brief move a contiguous chunk of elements into raw memory with memcpy
+         */
+        void move_chunk(T *src, size_type count, T *dest, std::true_type) noexcept;
+
+        /** move_chunk
+         * @brief move a contiguous chunk of elements into raw memory element by element,
+         * the elements moved so far are destroyed again if a move throws
+         */
+        void move_chunk(T *src, size_type count, T *dest, std::false_type);
+
+        /** drop_front
+         * @brief destroy the first element, the buffer must not be empty
+         */
+        void drop_front() noexcept;
+
+        /** drop_back
+         * @brief destroy the last element, the buffer must not be empty
+         */
+        void drop_back() noexcept;
+
+        /** erase_front
+         * @brief destroy the first count elements, count must not exceed the size
+         */
+        void erase_front(size_type count) noexcept;
+
+        /** append
+         * @brief push_back for ranges that can only be traversed once
+         */
+        template <class Iter>
+        void append(Iter first, Iter last, std::input_iterator_tag);
+
+        /** append
+         * @brief push_back for ranges with a known size, fills at most two contiguous chunks
+         */
+        template <class Iter>
+        void append(Iter first, Iter last, std::forward_iterator_tag);
+
+        /** append_chunk
+         * @brief copy count values into the free slots at dest, trivially copyable types
+         * are copied as one block
+         * @return iterator behind the last copied value
+         */
+        template <class Iter>
+        Iter append_chunk(T *dest, Iter first, size_type count, std::true_type);
+
+        /** append_chunk
+         * @brief construct count values in the free slots at dest one by one
+         * @return iterator behind the last copied value
+         */
+        template <class Iter>
+        Iter append_chunk(T *dest, Iter first, size_type count, std::false_type);
+
+        /** destroy
+         * @brief destroy the element at p, nothing to do for trivially destructible types
+         */
+        void destroy(T *p, std::true_type) noexcept;
+
+        /** destroy
+         * @brief destroy the element at p
+         */
+        void destroy(T *p, std::false_type) noexcept;
+
+        /** copy_from
+         * @brief append the elements of circ to the empty buffer, one block per readable segment
+         */
+        void copy_from(const circ_buffer &circ);
+
+        /** destroy_front
+         * @brief destroy the first count elements, nothing to do for trivially destructible types
+         */
+        void destroy_front(size_type count, std::true_type) noexcept;
+
+        /** destroy_front
+         * @brief destroy the first count elements
+         */
+        void destroy_front(size_type count, std::false_type) noexcept;
+
+        /** copy_chunk
+         * @brief copy a contiguous chunk of elements into a raw array with memcpy
+         */
+        static T *copy_chunk(const T *src, size_type count, T *dest, std::true_type) noexcept;
+
+        /** copy_chunk
+         * @brief copy a contiguous chunk of elements element by element
+         */
+        template <class OutIter>
+        static OutIter copy_chunk(const T *src, size_type count, OutIter dest, std::false_type);
+
         Alloc alloc_;
         T *buffer_;
-        size_type head_;
-        size_type tail_;
         size_type capacity_;
+        // packed_layout keeps the counters next to the members above,
+        // padded_layout moves each of them onto a cache line of its own
+        alignas(Layout::alignment) size_type head_;
+        alignas(Layout::alignment) size_type tail_;
     };
 
-    template <class T, class Alloc>
+    /** circ_buffer_pow2
+     * @brief circ_buffer with a power of two capacity, slots are addressed with a bitmask
+     */
+    template <class T, class Alloc = std::allocator<T>>
+    using circ_buffer_pow2 = circ_buffer<T, Alloc, pow2_index>;
+
+    /** circ_buffer_growing
+     * @brief circ_buffer that grows instead of overwriting, a deque with contiguous storage
+     */
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index>
+    using circ_buffer_growing = circ_buffer<T, Alloc, Index, no_stats, geometric_growth>;
+
+    /** circ_buffer_padded
+     * @brief circ_buffer with head_ and tail_ on separate cache lines
+     * and the elements starting at a cache line boundary
+     */
+    template <class T, class Index = modulo_index, std::size_t Line = 64>
+    using circ_buffer_padded = circ_buffer<T, cache_aligned_allocator<T, Line>, Index, no_stats, no_growth, padded_layout<Line>>;
+
+    /** for_each_segment
+     * @brief split the range of circ_buffer iterators into its contiguous parts (at most two)
+     * and call f(begin, end) with a pair of pointers for each of them,
+     * so the loops over the parts are flat and can be vectorized
+     * @return f
+     */
+    template <class Iter, class Func>
+    Func for_each_segment(Iter first, Iter last, Func f)
+    {
+        while (first < last)
+        {
+            auto segment = first.segment(last);
+            f(segment.begin(), segment.end());
+            first += static_cast<typename Iter::difference_type>(segment.size());
+        }
+        return f;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Container, class ValueType>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>::reference
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator*() const
+    {
+        return circ_->buffer_[Index::wrap(first_ + static_cast<size_type>(offset_), circ_->capacity_)];
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType>::reference
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator*() const
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>::pointer
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator->() const
     {
-        return circ_.buffer_[(circ_.head_ + static_cast<std::size_t>(static_cast<ptrdiff_t>(circ_.capacity_) + (offset_ % static_cast<ptrdiff_t>(circ_.capacity_))) % circ_.capacity_) % circ_.capacity_];
+        return &**this;
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType>::pointer
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator->()
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>::reference
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator[](difference_type n) const
     {
-        return &circ_.buffer_[(circ_.head_ + static_cast<std::size_t>(static_cast<ptrdiff_t>(circ_.capacity_) + (offset_ % static_cast<ptrdiff_t>(circ_.capacity_))) % circ_.capacity_) % circ_.capacity_];
+        return *(*this + n);
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType> &
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator++()
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType> &
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator++()
     {
         ++offset_;
         return *this;
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType>
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator++(int)
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator++(int)
     {
         basic_iterator tmp = *this;
         ++offset_;
         return tmp;
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType> &
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator--()
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType> &
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator--()
     {
         --offset_;
         return *this;
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType>
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator--(int)
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator--(int)
     {
         basic_iterator tmp = *this;
         --offset_;
         return tmp;
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Container, class ValueType>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType> &
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator+=(difference_type n)
+    {
+        offset_ += n;
+        return *this;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Container, class ValueType>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType> &
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator-=(difference_type n)
+    {
+        offset_ -= n;
+        return *this;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Container, class ValueType>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator+(difference_type n) const
+    {
+        basic_iterator tmp = *this;
+        return tmp += n;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Container, class ValueType>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator-(difference_type n) const
+    {
+        basic_iterator tmp = *this;
+        return tmp -= n;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Container, class ValueType>
-    typename circ_buffer<T, Alloc>::template basic_iterator<Container, ValueType>::difference_type
-    circ_buffer<T, Alloc>::basic_iterator<Container, ValueType>::operator-(const basic_iterator<Container, ValueType> &it) const
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::template basic_iterator<Container, ValueType>::difference_type
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::operator-(const basic_iterator<Container, ValueType> &it) const
     {
         return offset_ - it.offset_;
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc>::circ_buffer(const Alloc &a)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Container, class ValueType>
+    span<ValueType>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::basic_iterator<Container, ValueType>::segment(const basic_iterator &last) const
+    {
+        if (last.offset_ <= offset_)
+            return span<ValueType>();
+        auto pos = Index::wrap(first_ + static_cast<size_type>(offset_), circ_->capacity_);
+        auto count = static_cast<size_type>(last.offset_ - offset_);
+        return span<ValueType>(circ_->buffer_ + pos, count < circ_->capacity_ - pos ? count : circ_->capacity_ - pos);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::circ_buffer(const Alloc &a)
         : alloc_(a),
           buffer_(nullptr),
+          capacity_(0),
           head_(0),
-          tail_(0),
-          capacity_(0)
+          tail_(0)
     {
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc>::circ_buffer(size_type count, const Alloc &a)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::circ_buffer(size_type count, const Alloc &a)
         : alloc_(a),
-          buffer_(alloc_.allocate(count)),
+          buffer_(alloc_.allocate(Index::round_capacity(count))),
+          capacity_(Index::round_capacity(count)),
           head_(0),
-          tail_(0),
-          capacity_(count)
+          tail_(0)
     {
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class Iter>
-    circ_buffer<T, Alloc>::circ_buffer(Iter begin, Iter end, const Alloc &a)
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::circ_buffer(Iter begin, Iter end, const Alloc &a)
         : alloc_(a),
-          buffer_(alloc_.allocate(static_cast<std::size_t>(std::distance(begin, end)))),
+          buffer_(alloc_.allocate(Index::round_capacity(static_cast<std::size_t>(std::distance(begin, end))))),
+          capacity_(Index::round_capacity(static_cast<std::size_t>(std::distance(begin, end)))),
           head_(0),
-          tail_(0),
-          capacity_(static_cast<std::size_t>(std::distance(begin, end)))
+          tail_(0)
     {
-        std::copy(begin, end, std::back_inserter(*this));
+        push_back(begin, end);
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc>::circ_buffer(const circ_buffer &circ)
-        : alloc_(circ.alloc_),
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::circ_buffer(const circ_buffer &circ)
+        : Stats(circ),
+          alloc_(circ.alloc_),
           buffer_(alloc_.allocate(circ.capacity_)),
-          head_(circ.head_),
-          tail_(circ.tail_),
-          capacity_(circ.capacity_)
+          capacity_(circ.capacity_),
+          head_(0),
+          tail_(0)
     {
-        std::copy(circ.buffer_, circ.buffer_ + capacity_, buffer_);
+        try
+        {
+            copy_from(circ);
+        }
+        catch (...)
+        {
+            clear();
+            alloc_.deallocate(buffer_, capacity_);
+            throw;
+        }
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc>::circ_buffer(circ_buffer &&circ) noexcept
-        : alloc_(std::move(circ.alloc_)),
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::circ_buffer(circ_buffer &&circ) noexcept
+        : Stats(std::move(circ)),
+          alloc_(std::move(circ.alloc_)),
           buffer_(circ.buffer_),
+          capacity_(circ.capacity_),
           head_(circ.head_),
-          tail_(circ.tail_),
-          capacity_(circ.capacity_)
+          tail_(circ.tail_)
     {
-        circ.begin_ = nullptr;
-        circ.end_off_ = 0;
+        circ.buffer_ = nullptr;
+        circ.head_ = 0;
+        circ.tail_ = 0;
         circ.capacity_ = 0;
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc> &circ_buffer<T, Alloc>::operator=(const circ_buffer &circ)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout> &circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::operator=(const circ_buffer &circ)
     {
-        alloc_.deallocate(buffer_, capacity_);
-        alloc_ = circ.alloc_;
-        buffer_ = alloc_.allocate(circ.capacity_);
-        head_ = circ.head_;
-        tail_ = circ.tail_;
-        capacity_ = circ.capacity_;
-        std::copy(circ.buffer_, circ.buffer_ + capacity_, buffer_);
+        if (this == &circ)
+            return *this;
+        clear();
+        if (capacity_ != circ.capacity_ || !(alloc_ == circ.alloc_))
+        {
+            // allocate before giving up the old buffer, so a throwing allocation leaves *this valid
+            Alloc alloc(circ.alloc_);
+            auto buffer = alloc.allocate(circ.capacity_);
+            alloc_.deallocate(buffer_, capacity_);
+            alloc_ = alloc;
+            buffer_ = buffer;
+            capacity_ = circ.capacity_;
+        }
+        copy_from(circ);
         return *this;
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc> &circ_buffer<T, Alloc>::operator=(circ_buffer &&circ) noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout> &circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::operator=(circ_buffer &&circ) noexcept
     {
+        if (this == &circ)
+            return *this;
+        clear();
         alloc_.deallocate(buffer_, capacity_);
+        static_cast<Stats &>(*this) = std::move(circ);
         alloc_ = std::move(circ.alloc_);
         buffer_ = circ.buffer_;
         head_ = circ.head_;
@@ -434,259 +1083,919 @@ namespace raphia
         return *this;
     }
 
-    template <class T, class Alloc>
-    circ_buffer<T, Alloc>::~circ_buffer()
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::~circ_buffer()
     {
         clear();
         alloc_.deallocate(buffer_, capacity_);
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::iterator
-    circ_buffer<T, Alloc>::begin() noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::begin() noexcept
     {
         return iterator(0, *this);
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::iterator
-    circ_buffer<T, Alloc>::end() noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::end() noexcept
     {
         return iterator(static_cast<typename const_iterator::difference_type>(tail_ - head_), *this);
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_iterator
-    circ_buffer<T, Alloc>::cbegin() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::begin() const noexcept
     {
-        return const_iterator(0, *this);
+        return cbegin();
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_iterator
-    circ_buffer<T, Alloc>::cend() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::end() const noexcept
+    {
+        return cend();
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::cbegin() const noexcept
+    {
+        return const_iterator(0, *this);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::cend() const noexcept
     {
         return const_iterator(static_cast<typename const_iterator::difference_type>(tail_ - head_), *this);
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::reverse_iterator
-    circ_buffer<T, Alloc>::rbegin() noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reverse_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::rbegin() noexcept
     {
-        return std::reverse_iterator<iterator>(begin());
+        return reverse_iterator(end());
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::reverse_iterator
-    circ_buffer<T, Alloc>::rend() noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reverse_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::rend() noexcept
     {
-        return std::reverse_iterator<iterator>(end());
+        return reverse_iterator(begin());
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_reverse_iterator
-    circ_buffer<T, Alloc>::crbegin() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_reverse_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::crbegin() const noexcept
     {
-        return std::reverse_iterator<const_iterator>(cbegin());
+        return const_reverse_iterator(cend());
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_reverse_iterator
-    circ_buffer<T, Alloc>::crend() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_reverse_iterator
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::crend() const noexcept
     {
-        return std::reverse_iterator<const_iterator>(cend());
+        return const_reverse_iterator(cbegin());
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::push_back(value_type &&a)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::push_back(value_type &&a)
     {
         if (tail_ - head_ == capacity_)
-            pop_front();
-        auto p = &buffer_[tail_ % capacity_];
-        if (std::is_class<T>::value)
-            std::allocator_traits<Alloc>::construct(alloc_, p, std::move(a));
-        else
-            *p = std::move(a);
+        {
+            if (Growth::grows)
+            {
+                grow_back(std::move(a));
+                return;
+            }
+            drop_front();
+            this->on_overwrite_front(1);
+        }
+        auto p = &buffer_[Index::index(tail_, capacity_)];
+        std::allocator_traits<Alloc>::construct(alloc_, p, std::move(a));
         ++tail_;
+        this->on_push(1, tail_ - head_);
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::push_back(const value_type &a)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::push_back(const value_type &a)
     {
         if (tail_ - head_ == capacity_)
-            pop_front();
-        auto p = &buffer_[tail_ % capacity_];
-        if (std::is_class<T>::value)
-            std::allocator_traits<Alloc>::construct(alloc_, p, a);
-        else
-            *p = a;
+        {
+            if (Growth::grows)
+            {
+                grow_back(a);
+                return;
+            }
+            drop_front();
+            this->on_overwrite_front(1);
+        }
+        auto p = &buffer_[Index::index(tail_, capacity_)];
+        std::allocator_traits<Alloc>::construct(alloc_, p, a);
         ++tail_;
+        this->on_push(1, tail_ - head_);
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::push_front(value_type &&a)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::push_front(value_type &&a)
     {
         if (tail_ - head_ == capacity_)
-            pop_back();
-        std::size_t new_head = head_ - 1;
-        auto p = &buffer_[new_head % capacity_];
-        if (std::is_class<T>::value)
-            std::allocator_traits<Alloc>::construct(alloc_, p, std::move(a));
-        else
-            *p = std::move(a);
+        {
+            if (Growth::grows)
+            {
+                grow_front(std::move(a));
+                return;
+            }
+            drop_back();
+            this->on_overwrite_back(1);
+        }
+        std::size_t new_head = prev_head();
+        auto p = &buffer_[Index::index(new_head, capacity_)];
+        std::allocator_traits<Alloc>::construct(alloc_, p, std::move(a));
         head_ = new_head;
+        this->on_push(1, tail_ - head_);
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::push_front(const value_type &a)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::push_front(const value_type &a)
     {
         if (tail_ - head_ == capacity_)
-            pop_back();
-        std::size_t new_head = head_ - 1;
-        auto p = &buffer_[new_head % capacity_];
-        if (std::is_class<T>::value)
-            std::allocator_traits<Alloc>::construct(alloc_, p, a);
-        else
-            *p = a;
+        {
+            if (Growth::grows)
+            {
+                grow_front(a);
+                return;
+            }
+            drop_back();
+            this->on_overwrite_back(1);
+        }
+        std::size_t new_head = prev_head();
+        auto p = &buffer_[Index::index(new_head, capacity_)];
+        std::allocator_traits<Alloc>::construct(alloc_, p, a);
         head_ = new_head;
+        this->on_push(1, tail_ - head_);
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::size_type
-    circ_buffer<T, Alloc>::size() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::size_type
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::prev_head() noexcept
+    {
+        if (!Index::wraps && head_ == 0)
+        {
+            head_ += capacity_;
+            tail_ += capacity_;
+        }
+        return head_ - 1;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::size_type
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::size() const noexcept
     {
         return tail_ - head_;
     }
 
-    template <class T, class Alloc>
-    bool circ_buffer<T, Alloc>::empty() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    bool circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::empty() const noexcept
     {
         return (tail_ == head_);
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::pop_front()
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::pop_front()
     {
         if (size() > 0)
         {
-            if (std::is_class<T>::value)
-                buffer_[head_ % capacity_].~T();
-            ++head_;
+            drop_front();
+            this->on_pop(1);
         }
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::pop_back()
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::pop_back()
     {
         if (size() > 0)
         {
-            if (std::is_class<T>::value)
-                buffer_[(tail_ - 1) % capacity_].~T();
-            --tail_;
+            drop_back();
+            this->on_pop(1);
+        }
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::drop_front() noexcept
+    {
+        destroy(&buffer_[Index::index(head_, capacity_)], std::is_trivially_destructible<T>());
+        ++head_;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::drop_back() noexcept
+    {
+        destroy(&buffer_[Index::index(tail_ - 1, capacity_)], std::is_trivially_destructible<T>());
+        --tail_;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Iter, class>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::push_back(Iter first, Iter last)
+    {
+        append(first, last, typename std::iterator_traits<Iter>::iterator_category());
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Iter>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::append(Iter first, Iter last, std::input_iterator_tag)
+    {
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Iter>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::append(Iter first, Iter last, std::forward_iterator_tag)
+    {
+        auto count = static_cast<size_type>(std::distance(first, last));
+        if (Growth::grows && size() + count > capacity_)
+        {
+            auto next = Growth::next_capacity(capacity_);
+            reserve(next > size() + count ? next : size() + count);
+        }
+        if (count == 0 || capacity_ == 0)
+            return;
+        // make room up front, only the last capacity_ values would survive anyway,
+        // the stats count as if every value had been pushed on its own
+        this->on_push(count, size() + count < capacity_ ? size() + count : capacity_);
+        if (count >= capacity_)
+        {
+            std::advance(first, static_cast<typename std::iterator_traits<Iter>::difference_type>(count - capacity_));
+            this->on_overwrite_front(size() + count - capacity_);
+            erase_front(size());
+            count = capacity_;
+        }
+        else if (size() + count > capacity_)
+        {
+            this->on_overwrite_front(size() + count - capacity_);
+            erase_front(size() + count - capacity_);
+        }
+
+        using trivial = std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                                         std::is_same<typename std::iterator_traits<Iter>::value_type, T>::value>;
+        while (count)
+        {
+            auto pos = Index::index(tail_, capacity_);
+            auto chunk = count < capacity_ - pos ? count : capacity_ - pos;
+            first = append_chunk(buffer_ + pos, first, chunk, trivial());
+            count -= chunk;
         }
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Iter>
+    Iter circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::append_chunk(T *dest, Iter first, size_type count, std::true_type)
+    {
+        // std::copy boils down to memmove for pointers and the iterators of contiguous containers
+        auto last = std::next(first, static_cast<typename std::iterator_traits<Iter>::difference_type>(count));
+        std::copy(first, last, dest);
+        tail_ += count;
+        return last;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class Iter>
+    Iter circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::append_chunk(T *dest, Iter first, size_type count, std::false_type)
+    {
+        // account every element right away, so a throwing constructor leaves a consistent buffer
+        for (size_type i = 0; i < count; ++i, ++first)
+        {
+            std::allocator_traits<Alloc>::construct(alloc_, dest + i, *first);
+            ++tail_;
+        }
+        return first;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::pop_front(size_type count) noexcept
+    {
+        if (count > size())
+            count = size();
+        erase_front(count);
+        this->on_pop(count);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::erase_front(size_type count) noexcept
+    {
+        destroy_front(count, std::is_trivially_destructible<T>());
+        head_ += count;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::destroy(T *, std::true_type) noexcept
+    {
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::destroy(T *p, std::false_type) noexcept
+    {
+        std::allocator_traits<Alloc>::destroy(alloc_, p);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::destroy_front(size_type, std::true_type) noexcept
+    {
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::destroy_front(size_type count, std::false_type) noexcept
+    {
+        for (auto &segment : readable_segments())
+        {
+            auto n = count < segment.size() ? count : segment.size();
+            for (size_type i = 0; i < n; ++i)
+                std::allocator_traits<Alloc>::destroy(alloc_, segment.data() + i);
+            count -= n;
+        }
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class OutIter>
+    OutIter circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::copy_out(OutIter dest, size_type count) const
+    {
+        using trivial = std::integral_constant<bool, std::is_trivially_copyable<T>::value && std::is_same<OutIter, T *>::value>;
+        for (auto &segment : readable_segments())
+        {
+            auto n = count < segment.size() ? count : segment.size();
+            dest = copy_chunk(segment.data(), n, dest, trivial());
+            count -= n;
+        }
+        return dest;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    T *circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::copy_chunk(const T *src, size_type count, T *dest, std::true_type) noexcept
+    {
+        if (count)
+            std::memcpy(dest, src, count * sizeof(T));
+        return dest + count;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class OutIter>
+    OutIter circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::copy_chunk(const T *src, size_type count, OutIter dest, std::false_type)
+    {
+        return std::copy(src, src + count, dest);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class... Args>
-    typename circ_buffer<T, Alloc>::reference circ_buffer<T, Alloc>::emblace_front(Args &&...args)
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::emblace_front(Args &&...args)
     {
         if (tail_ - head_ == capacity_)
-            pop_back();
-        std::size_t new_head = head_ - 1;
-        auto p = &buffer_[new_head % capacity_];
+        {
+            if (Growth::grows)
+                return grow_front(std::forward<Args>(args)...);
+            drop_back();
+            this->on_overwrite_back(1);
+        }
+        std::size_t new_head = prev_head();
+        auto p = &buffer_[Index::index(new_head, capacity_)];
         std::allocator_traits<Alloc>::construct(alloc_, p, std::forward<Args>(args)...);
         head_ = new_head;
+        this->on_push(1, tail_ - head_);
         return *p;
     }
 
-    template <class T, class Alloc>
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
     template <class... Args>
-    typename circ_buffer<T, Alloc>::reference circ_buffer<T, Alloc>::emblace_back(Args &&...args)
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::emblace_back(Args &&...args)
     {
         if (tail_ - head_ == capacity_)
-            pop_front();
-        auto p = &buffer_[tail_ % capacity_];
+        {
+            if (Growth::grows)
+                return grow_back(std::forward<Args>(args)...);
+            drop_front();
+            this->on_overwrite_front(1);
+        }
+        auto p = &buffer_[Index::index(tail_, capacity_)];
         std::allocator_traits<Alloc>::construct(alloc_, p, std::forward<Args>(args)...);
         ++tail_;
+        this->on_push(1, tail_ - head_);
         return *p;
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::reference circ_buffer<T, Alloc>::front()
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::front()
     {
         if (empty())
             throw std::underflow_error("circ_buffer: tried to access empty container");
-        return buffer_[head_ % capacity_];
+        return buffer_[Index::index(head_, capacity_)];
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_reference circ_buffer<T, Alloc>::front() const
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::front() const
     {
         if (empty())
             throw std::underflow_error("circ_buffer: tried to access empty container");
-        return buffer_[head_ % capacity_];
+        return buffer_[Index::index(head_, capacity_)];
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::reference circ_buffer<T, Alloc>::back()
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::back()
     {
         if (empty())
             throw std::underflow_error("circ_buffer: tried to access empty container");
-        return buffer_[(tail_ - 1) % capacity_];
+        return buffer_[Index::index(tail_ - 1, capacity_)];
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_reference circ_buffer<T, Alloc>::back() const
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::back() const
     {
         if (empty())
             throw std::underflow_error("circ_buffer: tried to access empty container");
-        return buffer_[(tail_ - 1) % capacity_];
+        return buffer_[Index::index(tail_ - 1, capacity_)];
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_reference circ_buffer<T, Alloc>::operator[](int idx) const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::operator[](int idx) const noexcept
     {
-        return buffer_[(head_ + idx) % capacity_];
+        return buffer_[Index::index(head_ + static_cast<size_type>(idx), capacity_)];
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::const_reference circ_buffer<T, Alloc>::at(int idx) const
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::at(int idx) const
     {
         if (idx < 0 || idx >= size())
             throw std::out_of_range("circ_buffer: index out of range");
-        return buffer_[(head_ + idx) % capacity_];
+        return buffer_[Index::index(head_ + static_cast<size_type>(idx), capacity_)];
     }
 
-    template <class T, class Alloc>
-    typename circ_buffer<T, Alloc>::size_type circ_buffer<T, Alloc>::capacity() const noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::size_type circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::capacity() const noexcept
     {
         return capacity_;
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::clear() noexcept
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    circ_buffer_stats circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::stats() const noexcept
+    {
+        return this->snapshot();
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reset_stats() noexcept
+    {
+        this->reset();
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    span<T> circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::array_one() noexcept
     {
-        while (!empty())
-            pop_back();
+        return readable_segments()[0];
     }
 
-    template <class T, class Alloc>
-    void circ_buffer<T, Alloc>::set_capacity(size_type size)
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    span<const T> circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::array_one() const noexcept
     {
-        auto new_buffer = alloc_.allocate(size);
-        size_type offset = 0;
-        for (auto iter = begin(); iter != end(); ++iter)
+        return readable_segments()[0];
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    span<T> circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::array_two() noexcept
+    {
+        return readable_segments()[1];
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    span<const T> circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::array_two() const noexcept
+    {
+        return readable_segments()[1];
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::segments
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::readable_segments() noexcept
+    {
+        if (empty())
+            return segments();
+        auto first = Index::index(head_, capacity_);
+        auto count = size();
+        auto count_one = count < capacity_ - first ? count : capacity_ - first;
+        return {{span<T>(buffer_ + first, count_one), span<T>(buffer_, count - count_one)}};
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::const_segments
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::readable_segments() const noexcept
+    {
+        auto s = const_cast<circ_buffer *>(this)->readable_segments();
+        return {{span<const T>(s[0].data(), s[0].size()), span<const T>(s[1].data(), s[1].size())}};
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::segments
+    circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::prepare(size_type count) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "circ_buffer: prepare requires a trivially copyable type");
+        auto free = capacity_ - size();
+        if (count > free)
+            count = free;
+        if (count == 0)
+            return segments();
+        auto first = Index::index(tail_, capacity_);
+        auto count_one = count < capacity_ - first ? count : capacity_ - first;
+        return {{span<T>(buffer_ + first, count_one), span<T>(buffer_, count - count_one)}};
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::commit(size_type count) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "circ_buffer: commit requires a trivially copyable type");
+        auto free = capacity_ - size();
+        count = count < free ? count : free;
+        tail_ += count;
+        this->on_push(count, size());
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::consume(size_type count) noexcept
+    {
+        pop_front(count);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::clear() noexcept
+    {
+        // O(1) for trivially destructible types, nothing but the counters to reset
+        erase_front(size());
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::set_capacity(size_type size)
+    {
+        size = Index::round_capacity(size);
+        // the first elements are only dropped once the new buffer holds the others,
+        // a failing allocation or move leaves the buffer and the stats as they were
+        auto dropped = this->size() > size ? this->size() - size : 0;
+        reallocate(size, dropped);
+        if (dropped)
+            this->on_overwrite_front(dropped);
+        this->on_set_capacity();
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reserve(size_type count)
+    {
+        if (count <= capacity_)
+            return;
+        reallocate(Index::round_capacity(count));
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::shrink_to_fit()
+    {
+        auto count = Index::round_capacity(size());
+        if (count >= capacity_)
+            return;
+        reallocate(count);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reallocate(size_type new_capacity, size_type skip)
+    {
+        auto new_buffer = alloc_.allocate(new_capacity);
+        try
         {
-            std::allocator_traits<Alloc>::construct(alloc_, new_buffer + offset, std::move(*iter));
-            ++offset;
-            offset %= capacity_;
+            relocate(new_buffer, new_capacity, skip);
         }
-        clear();
+        catch (...)
+        {
+            alloc_.deallocate(new_buffer, new_capacity);
+            throw;
+        }
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class... Args>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::grow_back(Args &&...args)
+    {
+        auto new_capacity = Index::round_capacity(Growth::next_capacity(capacity_));
+        auto new_buffer = alloc_.allocate(new_capacity);
+        auto p = new_buffer + size();
+        try
+        {
+            std::allocator_traits<Alloc>::construct(alloc_, p, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            alloc_.deallocate(new_buffer, new_capacity);
+            throw;
+        }
+        try
+        {
+            relocate(new_buffer, new_capacity);
+        }
+        catch (...)
+        {
+            std::allocator_traits<Alloc>::destroy(alloc_, p);
+            alloc_.deallocate(new_buffer, new_capacity);
+            throw;
+        }
+        ++tail_;
+        this->on_push(1, size());
+        return *p;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    template <class... Args>
+    typename circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::reference circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::grow_front(Args &&...args)
+    {
+        // the new element takes the last slot, the old ones start at slot 0
+        auto new_capacity = Index::round_capacity(Growth::next_capacity(capacity_));
+        auto new_buffer = alloc_.allocate(new_capacity);
+        auto p = new_buffer + new_capacity - 1;
+        try
+        {
+            std::allocator_traits<Alloc>::construct(alloc_, p, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            alloc_.deallocate(new_buffer, new_capacity);
+            throw;
+        }
+        try
+        {
+            relocate(new_buffer, new_capacity);
+        }
+        catch (...)
+        {
+            std::allocator_traits<Alloc>::destroy(alloc_, p);
+            alloc_.deallocate(new_buffer, new_capacity);
+            throw;
+        }
+        head_ = new_capacity - 1;
+        tail_ += new_capacity;
+        this->on_push(1, size());
+        return *p;
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::relocate(T *new_buffer, size_type new_capacity, size_type skip)
+    {
+        using trivial = std::is_trivially_copyable<T>;
+        auto dest = new_buffer;
+        try
+        {
+            // at most two block moves, one per readable segment
+            for (auto &segment : readable_segments())
+            {
+                auto n = skip < segment.size() ? skip : segment.size();
+                skip -= n;
+                move_chunk(segment.data() + n, segment.size() - n, dest, trivial());
+                dest += segment.size() - n;
+            }
+        }
+        catch (...)
+        {
+            for (auto p = new_buffer; p != dest; ++p)
+                std::allocator_traits<Alloc>::destroy(alloc_, p);
+            throw;
+        }
+        // the skipped elements go together with the moved from ones
+        erase_front(size());
         alloc_.deallocate(buffer_, capacity_);
         buffer_ = new_buffer;
+        capacity_ = new_capacity;
         head_ = 0;
-        tail_ = offset;
-        capacity_ = size;
+        tail_ = static_cast<size_type>(dest - new_buffer);
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::move_chunk(T *src, size_type count, T *dest, std::true_type) noexcept
+    {
+        if (count)
+            std::memcpy(dest, src, count * sizeof(T));
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::move_chunk(T *src, size_type count, T *dest, std::false_type)
+    {
+        size_type i = 0;
+        try
+        {
+            for (; i < count; ++i)
+                std::allocator_traits<Alloc>::construct(alloc_, dest + i, std::move_if_noexcept(src[i]));
+        }
+        catch (...)
+        {
+            while (i--)
+                std::allocator_traits<Alloc>::destroy(alloc_, dest + i);
+            throw;
+        }
+    }
+
+    template <class T, class Alloc, class Index, class Stats, class Growth, class Layout>
+    void circ_buffer<T, Alloc, Index, Stats, Growth, Layout>::copy_from(const circ_buffer &circ)
+    {
+        // only the live elements, as memcpy for trivially copyable types,
+        // append_chunk leaves a consistent buffer if a copy constructor throws
+        using trivial = std::is_trivially_copyable<T>;
+        for (auto &segment : circ.readable_segments())
+            append_chunk(buffer_ + tail_, segment.data(), segment.size(), trivial());
+        static_cast<Stats &>(*this) = circ;
+    }
+
+    /** spsc_circ_buffer
+     * @brief lock-free circular buffer for exactly one producer and one consumer thread,
+     * unlike circ_buffer it never overwrites, pushing into a full buffer fails instead
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class spsc_circ_buffer
+    {
+    public:
+        using value_type = T;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using size_type = std::size_t;
+
+        /** Constructors **/
+
+        /** spsc_circ_buffer
+         * @brief constructor
+         * @param count buffer size, rounded according to the index policy
+         */
+        explicit spsc_circ_buffer(size_type count, const Alloc &a = Alloc());
+
+        spsc_circ_buffer(const spsc_circ_buffer &) = delete;
+        spsc_circ_buffer &operator=(const spsc_circ_buffer &) = delete;
+
+        /** Destructor **/
+
+        /** ~spsc_circ_buffer
+         * @brief deconstructor
+         */
+        ~spsc_circ_buffer();
+
+        /** Producer **/
+
+        /** try_push
+         * @brief add a value to the end of the buffer, may only be called by the producer
+         * @param a value to be added
+         * @return false if the buffer is full
+         */
+        bool try_push(value_type &&a);
+
+        /** try_push
+         * @brief add a value to the end of the buffer, may only be called by the producer
+         * @param a value to be added
+         * @return false if the buffer is full
+         */
+        bool try_push(const value_type &a);
+
+        /** try_emplace
+         * @brief constructs a new object at the end of the buffer, may only be called by the producer
+         * @return false if the buffer is full
+         */
+        template <class... Args>
+        bool try_emplace(Args &&...args);
+
+        /** Consumer **/
+
+        /** try_pop
+         * @brief move the first element out of the buffer, may only be called by the consumer
+         * @param a receives the element
+         * @return false if the buffer is empty
+         */
+        bool try_pop(value_type &a);
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer,
+         * the value may be outdated as soon as it is returned if the other side is active
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty, see size()
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        static constexpr std::size_t cache_line = 64;
+
+        // consumer side, cached_tail_ is the last tail_ the consumer has seen
+        alignas(cache_line) std::atomic<size_type> head_;
+        size_type cached_tail_;
+
+        // producer side, cached_head_ is the last head_ the producer has seen
+        alignas(cache_line) std::atomic<size_type> tail_;
+        size_type cached_head_;
+
+        // shared, but never written after construction
+        alignas(cache_line) Alloc alloc_;
+        T *buffer_;
+        size_type capacity_;
+    };
+
+    template <class T, class Alloc, class Index>
+    spsc_circ_buffer<T, Alloc, Index>::spsc_circ_buffer(size_type count, const Alloc &a)
+        : head_(0),
+          cached_tail_(0),
+          tail_(0),
+          cached_head_(0),
+          alloc_(a),
+          buffer_(alloc_.allocate(Index::round_capacity(count))),
+          capacity_(Index::round_capacity(count))
+    {
+    }
+
+    template <class T, class Alloc, class Index>
+    spsc_circ_buffer<T, Alloc, Index>::~spsc_circ_buffer()
+    {
+        for (auto pos = head_.load(std::memory_order_relaxed); pos != tail_.load(std::memory_order_relaxed); ++pos)
+            std::allocator_traits<Alloc>::destroy(alloc_, &buffer_[Index::index(pos, capacity_)]);
+        alloc_.deallocate(buffer_, capacity_);
+    }
+
+    template <class T, class Alloc, class Index>
+    bool spsc_circ_buffer<T, Alloc, Index>::try_push(value_type &&a)
+    {
+        return try_emplace(std::move(a));
+    }
+
+    template <class T, class Alloc, class Index>
+    bool spsc_circ_buffer<T, Alloc, Index>::try_push(const value_type &a)
+    {
+        return try_emplace(a);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    bool spsc_circ_buffer<T, Alloc, Index>::try_emplace(Args &&...args)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_)
+                return false;
+        }
+        std::allocator_traits<Alloc>::construct(alloc_, &buffer_[Index::index(tail, capacity_)], std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T, class Alloc, class Index>
+    bool spsc_circ_buffer<T, Alloc, Index>::try_pop(value_type &a)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_)
+                return false;
+        }
+        auto p = &buffer_[Index::index(head, capacity_)];
+        a = std::move(*p);
+        std::allocator_traits<Alloc>::destroy(alloc_, p);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T, class Alloc, class Index>
+    typename spsc_circ_buffer<T, Alloc, Index>::size_type
+    spsc_circ_buffer<T, Alloc, Index>::size() const noexcept
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        auto size = tail_.load(std::memory_order_acquire) - head;
+        // both sides may have moved on between the two loads
+        return size < capacity_ ? size : capacity_;
+    }
+
+    template <class T, class Alloc, class Index>
+    bool spsc_circ_buffer<T, Alloc, Index>::empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    template <class T, class Alloc, class Index>
+    typename spsc_circ_buffer<T, Alloc, Index>::size_type
+    spsc_circ_buffer<T, Alloc, Index>::capacity() const noexcept
+    {
+        return capacity_;
     }
 } // namespace raphia
 #endif
@@ -0,0 +1,218 @@
+#ifndef RAPHIA_HUGE_PAGE_ALLOCATOR_HPP
+#define RAPHIA_HUGE_PAGE_ALLOCATOR_HPP
+#include "circ_buffer.hpp"
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+#include <vector>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace raphia
+{
+    /** huge_page_mode
+     * @brief how huge_page_allocator asks for huge pages
+     */
+    enum class huge_page_mode
+    {
+        none,        // regular pages
+        transparent, // madvise(MADV_HUGEPAGE), the kernel backs the block with huge pages when it can
+        hugetlb      // MAP_HUGETLB from the reserved pool, falls back to transparent if the pool is empty
+    };
+
+    /** huge_page_options
+     * @brief settings of a huge_page_allocator
+     */
+    struct huge_page_options
+    {
+        huge_page_mode mode = huge_page_mode::transparent;
+        /** NUMA node the memory is bound to with mbind, -1 leaves the placement to the kernel */
+        int numa_node = -1;
+        /** touch every page in allocate, so the first lap through the ring doesn't page fault */
+        bool prefault = true;
+    };
+
+    inline bool operator==(const huge_page_options &a, const huge_page_options &b) noexcept
+    {
+        return a.mode == b.mode && a.numa_node == b.numa_node && a.prefault == b.prefault;
+    }
+
+    /** numa_node_mask
+     * @brief nodemask and maxnode arguments of mbind for binding to a single node
+     */
+    struct numa_node_mask
+    {
+        /** numa_node_mask
+         * @brief constructor
+         * @param node index of the NUMA node, not negative
+         */
+        explicit numa_node_mask(int node);
+
+        std::vector<unsigned long> nodes;
+        /** the kernel reads maxnode - 1 bits, so this is one more than the bits in nodes, like libnuma passes it */
+        unsigned long maxnode;
+    };
+
+    inline numa_node_mask::numa_node_mask(int node)
+    {
+        const auto bits = 8 * sizeof(unsigned long);
+        auto n = static_cast<std::size_t>(node);
+        nodes.assign(n / bits + 1, 0);
+        nodes[n / bits] = 1ul << (n % bits);
+        maxnode = nodes.size() * bits + 1;
+    }
+
+    /** huge_page_allocator
+     * @brief allocator for large rings, every block is mapped on its own, aligned to
+     * and rounded up to huge_page_size, optionally bound to a NUMA node and pre-faulted.
+     * Small blocks waste most of a huge page, use it for buffers of megabytes and more.
+     */
+    template <class T>
+    class huge_page_allocator
+    {
+    public:
+        using value_type = T;
+
+        template <class U>
+        struct rebind
+        {
+            using other = huge_page_allocator<U>;
+        };
+
+        /** size of a huge page on x86-64 and most arm64 kernels */
+        static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+        huge_page_allocator() noexcept = default;
+
+        /** huge_page_allocator
+         * @brief constructor
+         * @param options huge page mode, NUMA node and pre-faulting
+         */
+        explicit huge_page_allocator(const huge_page_options &options) noexcept : options_(options) {}
+
+        template <class U>
+        huge_page_allocator(const huge_page_allocator<U> &a) noexcept : options_(a.options())
+        {
+        }
+
+        /** allocate
+         * @brief map room for count elements
+         * @throw bad_alloc if the memory can't be mapped
+         * @throw system_error if it can't be bound to the NUMA node
+         */
+        T *allocate(std::size_t count);
+
+        /** deallocate
+         * @brief unmap a block returned by allocate
+         */
+        void deallocate(T *p, std::size_t count) noexcept;
+
+        /** options
+         * @brief the settings of the allocator
+         */
+        const huge_page_options &options() const noexcept { return options_; }
+
+    private:
+        /** mapping_size
+         * @brief bytes mapped for count elements
+         */
+        static std::size_t mapping_size(std::size_t count) noexcept;
+
+        /** map_aligned
+         * @brief map length bytes at a huge page boundary, nullptr if that fails
+         */
+        static char *map_aligned(std::size_t length) noexcept;
+
+        huge_page_options options_;
+    };
+
+    template <class T>
+    std::size_t huge_page_allocator<T>::mapping_size(std::size_t count) noexcept
+    {
+        return (count * sizeof(T) + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    template <class T>
+    char *huge_page_allocator<T>::map_aligned(std::size_t length) noexcept
+    {
+        // mmap only guarantees page alignment, map a huge page more and trim both ends
+        auto raw = ::mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            return nullptr;
+        auto begin = static_cast<char *>(raw);
+        auto aligned = reinterpret_cast<char *>((reinterpret_cast<std::uintptr_t>(begin) + huge_page_size - 1) & ~(huge_page_size - 1));
+        if (aligned != begin)
+            ::munmap(begin, static_cast<std::size_t>(aligned - begin));
+        auto end = begin + length + huge_page_size;
+        if (end != aligned + length)
+            ::munmap(aligned + length, static_cast<std::size_t>(end - (aligned + length)));
+        return aligned;
+    }
+
+    template <class T>
+    T *huge_page_allocator<T>::allocate(std::size_t count)
+    {
+        if (count == 0)
+            return nullptr;
+        if (count > (static_cast<std::size_t>(-1) - huge_page_size) / sizeof(T))
+            throw std::bad_alloc();
+        auto length = mapping_size(count);
+        char *p = nullptr;
+        if (options_.mode == huge_page_mode::hugetlb)
+        {
+            auto raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (raw != MAP_FAILED)
+                p = static_cast<char *>(raw);
+        }
+        bool transparent = !p && options_.mode != huge_page_mode::none;
+        if (!p)
+            p = map_aligned(length);
+        if (!p)
+            throw std::bad_alloc();
+        if (transparent)
+            ::madvise(p, length, MADV_HUGEPAGE); // a kernel without THP just ignores the hint
+        if (options_.numa_node >= 0)
+        {
+            // the memory isn't touched yet, so every page is placed according to the policy
+            numa_node_mask mask(options_.numa_node);
+            if (::syscall(SYS_mbind, p, length, MPOL_BIND, mask.nodes.data(), mask.maxnode, 0) != 0)
+            {
+                auto err = errno;
+                ::munmap(p, length);
+                throw std::system_error(err, std::generic_category(), "huge_page_allocator: mbind failed");
+            }
+        }
+        if (options_.prefault)
+        {
+            // one write per regular page, with huge pages the first one faults in the whole huge page
+            auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            for (std::size_t offset = 0; offset < length; offset += page)
+                static_cast<volatile char *>(p)[offset] = 0;
+        }
+        return reinterpret_cast<T *>(p);
+    }
+
+    template <class T>
+    void huge_page_allocator<T>::deallocate(T *p, std::size_t count) noexcept
+    {
+        if (p)
+            ::munmap(p, mapping_size(count));
+    }
+
+    template <class T, class U>
+    bool operator==(const huge_page_allocator<T> &a, const huge_page_allocator<U> &b) noexcept
+    {
+        return a.options() == b.options();
+    }
+
+    template <class T, class U>
+    bool operator!=(const huge_page_allocator<T> &a, const huge_page_allocator<U> &b) noexcept
+    {
+        return !(a == b);
+    }
+} // namespace raphia
+#endif
+#endif
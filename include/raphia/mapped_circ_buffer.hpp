@@ -0,0 +1,482 @@
+#ifndef RAPHIA_MAPPED_CIRC_BUFFER_HPP
+#define RAPHIA_MAPPED_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#if defined(__unix__)
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace raphia
+{
+    /** mapped_circ_buffer
+     * @brief circular buffer that lives in a memory mapped file, e.g. a flight recorder
+     * that survives a crash of the process. The file starts with a header
+     * (magic, version, element size, capacity, head, tail) followed by the slots.
+     * Elements are written before the tail that publishes them and the head moves before
+     * a slot gets overwritten, so after a kill -9 the file holds a consistent sequence.
+     * Reopening only maps the file and checks the header.
+     * Surviving a power loss in addition needs sync().
+     */
+    template <class T, class Index = modulo_index>
+    class mapped_circ_buffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "mapped_circ_buffer: T must be trivially copyable");
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "mapped_circ_buffer: 64 bit atomics must be lock free");
+
+    public:
+        using value_type = T;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using size_type = std::size_t;
+        using const_segments = std::array<raphia::span<const T>, 2>;
+
+        /** const_iterator
+         * @brief random access iterator over the elements, oldest first
+         */
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+            using pointer = const T *;
+            using reference = const T &;
+
+            const_iterator() noexcept : offset_(0), circ_(nullptr) {}
+            const_iterator(difference_type offset, const mapped_circ_buffer &circ) noexcept : offset_(offset), circ_(&circ) {}
+
+            reference operator*() const { return (*circ_)[static_cast<size_type>(offset_)]; }
+            pointer operator->() const { return &**this; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+            const_iterator &operator++() { ++offset_; return *this; }
+            const_iterator operator++(int) { auto it = *this; ++offset_; return it; }
+            const_iterator &operator--() { --offset_; return *this; }
+            const_iterator operator--(int) { auto it = *this; --offset_; return it; }
+            const_iterator &operator+=(difference_type n) { offset_ += n; return *this; }
+            const_iterator &operator-=(difference_type n) { offset_ -= n; return *this; }
+            const_iterator operator+(difference_type n) const { return const_iterator(offset_ + n, *circ_); }
+            const_iterator operator-(difference_type n) const { return const_iterator(offset_ - n, *circ_); }
+            difference_type operator-(const const_iterator &it) const { return offset_ - it.offset_; }
+
+            friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+            friend bool operator==(const const_iterator &a, const const_iterator &b) { return a.offset_ == b.offset_; }
+            friend bool operator!=(const const_iterator &a, const const_iterator &b) { return a.offset_ != b.offset_; }
+            friend bool operator<(const const_iterator &a, const const_iterator &b) { return a.offset_ < b.offset_; }
+            friend bool operator>(const const_iterator &a, const const_iterator &b) { return a.offset_ > b.offset_; }
+            friend bool operator<=(const const_iterator &a, const const_iterator &b) { return a.offset_ <= b.offset_; }
+            friend bool operator>=(const const_iterator &a, const const_iterator &b) { return a.offset_ >= b.offset_; }
+
+        private:
+            difference_type offset_;
+            const mapped_circ_buffer *circ_;
+        };
+
+        /** Constructors **/
+
+        /** mapped_circ_buffer
+         * @brief opens the buffer in the file at path, the file is created and initialized
+         * if it doesn't exist, is empty or its initialization has been interrupted
+         * @param path file to map
+         * @param count buffer size for a new file, rounded according to the index policy,
+         * an existing file keeps its capacity
+         * @throw system_error if the file can't be opened or mapped
+         * @throw runtime_error if the file holds no buffer of this type
+         */
+        mapped_circ_buffer(const std::string &path, size_type count);
+
+        mapped_circ_buffer(const mapped_circ_buffer &) = delete;
+
+        /** mapped_circ_buffer
+         * @brief move constructor
+         */
+        mapped_circ_buffer(mapped_circ_buffer &&) noexcept;
+
+        /** Destructor **/
+
+        /** ~mapped_circ_buffer
+         * @brief unmaps the file, the elements stay in it
+         */
+        ~mapped_circ_buffer();
+
+        /** Copy/Move operators **/
+
+        mapped_circ_buffer &operator=(const mapped_circ_buffer &) = delete;
+
+        /** operator=
+         * @brief move operator
+         */
+        mapped_circ_buffer &operator=(mapped_circ_buffer &&) noexcept;
+
+        /** Iterators **/
+
+        /** begin
+         * @brief retrieves an iterator to the first element
+         */
+        const_iterator begin() const noexcept;
+
+        /** end
+         * @brief retrieves an iterator behind the last element
+         */
+        const_iterator end() const noexcept;
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a value to the end of the circular buffer,
+         * if the buffer is full, the first element will be overwritten
+         * @param a value to be added
+         */
+        void push_back(const value_type &a) noexcept;
+
+        /** pop_front
+         * @brief remove the first element from the buffer
+         */
+        void pop_front() noexcept;
+
+        /** clear
+         * @brief clear the buffer
+         */
+        void clear() noexcept;
+
+        /** sync
+         * @brief write the mapped pages back to the file and wait for it
+         * @throw system_error if msync fails
+         */
+        void sync();
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+        /** Accessors **/
+
+        /** front
+         * @brief access the first element in the buffer
+         * @return const reference to the first element
+         * @throw underflow_error if the buffer is empty
+         */
+        const_reference front() const;
+
+        /** back
+         * @brief access the last element in the buffer
+         * @return const reference to the last element
+         * @throw underflow_error if the buffer is empty
+         */
+        const_reference back() const;
+
+        /** operator[]
+         * @brief access an element by index
+         * @return const reference to the element at the given index
+         */
+        const_reference operator[](size_type idx) const noexcept;
+
+        /** at
+         * @brief access an element by index
+         * @return const reference to the element at the given index
+         * @throw out_of_range exception if the index lies not in the buffer range
+         */
+        const_reference at(size_type idx) const;
+
+        /** readable_segments
+         * @brief the elements as two contiguous parts, e.g. to write them out
+         */
+        const_segments readable_segments() const noexcept;
+
+    private:
+        static constexpr std::uint64_t magic = 0x4655425243524152; // "RARCRBUF" in little endian
+        static constexpr std::uint32_t version = 1;
+
+        struct header
+        {
+            std::uint64_t magic;
+            std::uint32_t version;
+            std::uint32_t element_size;
+            std::uint64_t capacity;
+            std::atomic<std::uint64_t> head;
+            std::atomic<std::uint64_t> tail;
+        };
+
+        /** data_offset
+         * @brief offset of the first slot in the file
+         */
+        static constexpr size_type data_offset() noexcept
+        {
+            return (sizeof(header) + alignof(T) - 1) / alignof(T) * alignof(T);
+        }
+
+        /** map
+         * @brief map length bytes of the open file
+         */
+        void map(int fd, size_type length);
+
+        /** release
+         * @brief unmaps the file
+         */
+        void release() noexcept;
+
+        header *header_;
+        T *buffer_;
+        size_type capacity_;
+        size_type length_;
+    };
+
+    template <class T, class Index>
+    mapped_circ_buffer<T, Index>::mapped_circ_buffer(const std::string &path, size_type count)
+        : header_(nullptr),
+          buffer_(nullptr),
+          capacity_(0),
+          length_(0)
+    {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "mapped_circ_buffer: open failed");
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            auto err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "mapped_circ_buffer: fstat failed");
+        }
+        auto file_size = static_cast<size_type>(st.st_size);
+        try
+        {
+            size_type existing = 0;
+            if (file_size >= sizeof(header))
+            {
+                // all we need to know about an existing buffer is in the header
+                map(fd, sizeof(header));
+                if (header_->magic != 0)
+                {
+                    bool valid = header_->magic == magic && header_->version == version &&
+                                 header_->element_size == sizeof(T) && header_->capacity > 0 &&
+                                 header_->capacity == Index::round_capacity(static_cast<size_type>(header_->capacity));
+                    if (!valid)
+                        throw std::runtime_error("mapped_circ_buffer: the file holds no buffer of this type");
+                    existing = static_cast<size_type>(header_->capacity);
+                }
+                release();
+            }
+            if (existing)
+            {
+                if (file_size < data_offset() + existing * sizeof(T))
+                    throw std::runtime_error("mapped_circ_buffer: the file is truncated");
+                map(fd, data_offset() + existing * sizeof(T));
+                capacity_ = existing;
+                auto head = header_->head.load(std::memory_order_acquire);
+                auto tail = header_->tail.load(std::memory_order_acquire);
+                if (tail - head > capacity_)
+                    throw std::runtime_error("mapped_circ_buffer: the header is corrupt");
+            }
+            else
+            {
+                capacity_ = Index::round_capacity(count);
+                if (capacity_ == 0)
+                    throw std::invalid_argument("mapped_circ_buffer: capacity must not be 0");
+                if (::ftruncate(fd, static_cast<off_t>(data_offset() + capacity_ * sizeof(T))) != 0)
+                    throw std::system_error(errno, std::generic_category(), "mapped_circ_buffer: ftruncate failed");
+                map(fd, data_offset() + capacity_ * sizeof(T));
+                header_->version = version;
+                header_->element_size = static_cast<std::uint32_t>(sizeof(T));
+                header_->capacity = capacity_;
+                new (&header_->head) std::atomic<std::uint64_t>(0);
+                new (&header_->tail) std::atomic<std::uint64_t>(0);
+                // the magic goes last, a file without it is initialized again on the next open
+                std::atomic_thread_fence(std::memory_order_release);
+                header_->magic = magic;
+            }
+        }
+        catch (...)
+        {
+            release();
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        buffer_ = reinterpret_cast<T *>(reinterpret_cast<char *>(header_) + data_offset());
+    }
+
+    template <class T, class Index>
+    mapped_circ_buffer<T, Index>::mapped_circ_buffer(mapped_circ_buffer &&circ) noexcept
+        : header_(circ.header_),
+          buffer_(circ.buffer_),
+          capacity_(circ.capacity_),
+          length_(circ.length_)
+    {
+        circ.header_ = nullptr;
+        circ.buffer_ = nullptr;
+        circ.capacity_ = 0;
+        circ.length_ = 0;
+    }
+
+    template <class T, class Index>
+    mapped_circ_buffer<T, Index>::~mapped_circ_buffer()
+    {
+        release();
+    }
+
+    template <class T, class Index>
+    mapped_circ_buffer<T, Index> &mapped_circ_buffer<T, Index>::operator=(mapped_circ_buffer &&circ) noexcept
+    {
+        if (this == &circ)
+            return *this;
+        release();
+        header_ = circ.header_;
+        buffer_ = circ.buffer_;
+        capacity_ = circ.capacity_;
+        length_ = circ.length_;
+        circ.header_ = nullptr;
+        circ.buffer_ = nullptr;
+        circ.capacity_ = 0;
+        circ.length_ = 0;
+        return *this;
+    }
+
+    template <class T, class Index>
+    void mapped_circ_buffer<T, Index>::map(int fd, size_type length)
+    {
+        auto p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "mapped_circ_buffer: mmap failed");
+        header_ = static_cast<header *>(p);
+        length_ = length;
+    }
+
+    template <class T, class Index>
+    void mapped_circ_buffer<T, Index>::release() noexcept
+    {
+        if (header_)
+            ::munmap(header_, length_);
+        header_ = nullptr;
+        buffer_ = nullptr;
+        length_ = 0;
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_iterator mapped_circ_buffer<T, Index>::begin() const noexcept
+    {
+        return const_iterator(0, *this);
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_iterator mapped_circ_buffer<T, Index>::end() const noexcept
+    {
+        return const_iterator(static_cast<typename const_iterator::difference_type>(size()), *this);
+    }
+
+    template <class T, class Index>
+    void mapped_circ_buffer<T, Index>::push_back(const value_type &a) noexcept
+    {
+        auto head = header_->head.load(std::memory_order_relaxed);
+        auto tail = header_->tail.load(std::memory_order_relaxed);
+        // retire the oldest element before its slot gets overwritten
+        if (tail - head == capacity_)
+            header_->head.store(head + 1, std::memory_order_release);
+        std::memcpy(&buffer_[Index::index(static_cast<size_type>(tail), capacity_)], &a, sizeof(T));
+        // publish the element only once it is complete
+        header_->tail.store(tail + 1, std::memory_order_release);
+    }
+
+    template <class T, class Index>
+    void mapped_circ_buffer<T, Index>::pop_front() noexcept
+    {
+        auto head = header_->head.load(std::memory_order_relaxed);
+        if (head != header_->tail.load(std::memory_order_relaxed))
+            header_->head.store(head + 1, std::memory_order_release);
+    }
+
+    template <class T, class Index>
+    void mapped_circ_buffer<T, Index>::clear() noexcept
+    {
+        header_->head.store(header_->tail.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    template <class T, class Index>
+    void mapped_circ_buffer<T, Index>::sync()
+    {
+        if (::msync(header_, length_, MS_SYNC) != 0)
+            throw std::system_error(errno, std::generic_category(), "mapped_circ_buffer: msync failed");
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::size_type mapped_circ_buffer<T, Index>::size() const noexcept
+    {
+        return static_cast<size_type>(header_->tail.load(std::memory_order_relaxed) - header_->head.load(std::memory_order_relaxed));
+    }
+
+    template <class T, class Index>
+    bool mapped_circ_buffer<T, Index>::empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::size_type mapped_circ_buffer<T, Index>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_reference mapped_circ_buffer<T, Index>::front() const
+    {
+        if (empty())
+            throw std::underflow_error("mapped_circ_buffer: tried to access empty container");
+        return (*this)[0];
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_reference mapped_circ_buffer<T, Index>::back() const
+    {
+        if (empty())
+            throw std::underflow_error("mapped_circ_buffer: tried to access empty container");
+        return (*this)[size() - 1];
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_reference mapped_circ_buffer<T, Index>::operator[](size_type idx) const noexcept
+    {
+        auto head = static_cast<size_type>(header_->head.load(std::memory_order_relaxed));
+        return buffer_[Index::index(head + idx, capacity_)];
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_reference mapped_circ_buffer<T, Index>::at(size_type idx) const
+    {
+        if (idx >= size())
+            throw std::out_of_range("mapped_circ_buffer: index out of range");
+        return (*this)[idx];
+    }
+
+    template <class T, class Index>
+    typename mapped_circ_buffer<T, Index>::const_segments mapped_circ_buffer<T, Index>::readable_segments() const noexcept
+    {
+        if (empty())
+            return const_segments();
+        auto first = Index::index(static_cast<size_type>(header_->head.load(std::memory_order_relaxed)), capacity_);
+        auto count = size();
+        auto count_one = count < capacity_ - first ? count : capacity_ - first;
+        return {{raphia::span<const T>(buffer_ + first, count_one), raphia::span<const T>(buffer_, count - count_one)}};
+    }
+} // namespace raphia
+#endif
+#endif
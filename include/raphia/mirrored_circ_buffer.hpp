@@ -0,0 +1,561 @@
+#ifndef RAPHIA_MIRRORED_CIRC_BUFFER_HPP
+#define RAPHIA_MIRRORED_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#if defined(__linux__)
+#include <cerrno>
+#include <system_error>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace raphia
+{
+    /** mirrored_circ_buffer
+     * @brief circular buffer whose pages are mapped twice back to back,
+     * so the elements are always one contiguous range starting at data().
+     * The capacity is rounded up so the buffer fills whole pages.
+     * Elements are constructed in the first mapping but may be used through the second,
+     * at another address, so T has to be trivially copyable.
+     */
+    template <class T>
+    class mirrored_circ_buffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "mirrored_circ_buffer: T must be trivially copyable");
+
+    public:
+        using value_type = T;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+        using size_type = std::size_t;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+
+        /** Constructors **/
+
+        /** mirrored_circ_buffer
+         * @brief default constructor
+         */
+        mirrored_circ_buffer() noexcept;
+
+        /** mirrored_circ_buffer
+         * @brief constructor
+         * @param count minimal buffer size
+         * @throw length_error if both halves of the buffer would exceed the address space
+         * @throw system_error if the mapping can't be created
+         */
+        explicit mirrored_circ_buffer(size_type count);
+
+        mirrored_circ_buffer(const mirrored_circ_buffer &) = delete;
+
+        /** mirrored_circ_buffer
+         * @brief move constructor
+         */
+        mirrored_circ_buffer(mirrored_circ_buffer &&) noexcept;
+
+        /** Destructor **/
+
+        /** ~mirrored_circ_buffer
+         * @brief deconstructor
+         */
+        ~mirrored_circ_buffer();
+
+        /** Copy/Move operators **/
+
+        mirrored_circ_buffer &operator=(const mirrored_circ_buffer &) = delete;
+
+        /** operator=
+         * @brief move operator
+         */
+        mirrored_circ_buffer &operator=(mirrored_circ_buffer &&) noexcept;
+
+        /** Iterators **/
+
+        /** begin
+         * @brief retrieves an iterator the first element
+         * @return pointer to the first element
+         */
+        iterator begin() noexcept;
+
+        /** end
+         * @brief retrieves an iterator behind the last element
+         * @return pointer behind the last element
+         */
+        iterator end() noexcept;
+
+        /** cbegin
+         * @brief retrieves a constant iterator the first element
+         * @return constant pointer to the first element
+         */
+        const_iterator cbegin() const noexcept;
+
+        /** cend
+         * @brief retrieves a constant iterator behind the last element
+         * @return constant pointer behind the last element
+         */
+        const_iterator cend() const noexcept;
+
+        /** Contiguous access **/
+
+        /** data
+         * @brief pointer to the first element, the following size() elements are contiguous
+         */
+        pointer data() noexcept;
+
+        /** data
+         * @brief pointer to the first element, the following size() elements are contiguous
+         */
+        const_pointer data() const noexcept;
+
+        /** span
+         * @brief all elements in the buffer as one contiguous range
+         */
+        raphia::span<T> span() noexcept;
+
+        /** span
+         * @brief all elements in the buffer as one contiguous range
+         */
+        raphia::span<const T> span() const noexcept;
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a value to the end of the circular buffer,
+         * if the buffer is full, the first element will be overwritten
+         * @param a value to be added
+         */
+        void push_back(value_type &&a);
+
+        /** push_back
+         * @brief add a value to the end of the circular buffer,
+         * if the buffer is full, the first element will be overwritten
+         * @param a value to be added
+         */
+        void push_back(const value_type &a);
+
+        /** push_front
+         * @brief add a value to the front of the circular buffer,
+         * if the buffer is full, the last element will be overwritten
+         * @param a value to be added
+         */
+        void push_front(value_type &&a);
+
+        /** push_front
+         * @brief add a value to the front of the circular buffer,
+         * if the buffer is full, the last element will be overwritten
+         * @param a value to be added
+         */
+        void push_front(const value_type &a);
+
+        /** pop_front
+         * @brief remove the first element from the buffer
+         */
+        void pop_front();
+
+        /** pop_back
+         * @brief remove the last element from the buffer
+         */
+        void pop_back();
+
+        /** emblace_front
+         * @brief constructs a new object at the front of the buffer
+         * @returns a reference to the newly constructed object
+         */
+        template <class... Args>
+        reference emblace_front(Args &&...args);
+
+        /** emblace_back
+         * @brief constructs a new object at the back of the buffer
+         * @returns a reference to the newly constructed object
+         */
+        template <class... Args>
+        reference emblace_back(Args &&...args);
+
+        /** clear
+         * @brief clear the buffer
+         */
+        void clear() noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+        /** Accessors **/
+
+        /** front
+         * @brief access the first element in the buffer
+         * @return reference to the first element
+         * @throw underflow_error if the buffer is empty
+         */
+        reference front();
+
+        /** front
+         * @brief access the first element in the buffer
+         * @return const reference to the first element
+         * @throw underflow_error if the buffer is empty
+         */
+        const_reference front() const;
+
+        /** back
+         * @brief access the last element in the buffer
+         * @return reference to the last element
+         * @throw underflow_error if the buffer is empty
+         */
+        reference back();
+
+        /** back
+         * @brief access the last element in the buffer
+         * @return const reference to the last element
+         * @throw underflow_error if the buffer is empty
+         */
+        const_reference back() const;
+
+        /** operator[]
+         * @brief access an element by index
+         * @return const reference to the element at the given index
+         */
+        const_reference operator[](size_type idx) const noexcept;
+
+        /** at
+         * @brief access an element by index
+         * @return const reference to the element at the given index
+         * @throw out_of_range exception if the index lies not in the buffer range
+         */
+        const_reference at(size_type idx) const;
+
+    private:
+        /** prev_head
+         * @brief counter position in front of the head, rebases the counters before they wrap
+         */
+        size_type prev_head() noexcept;
+
+        /** release
+         * @brief destroys the elements and unmaps the buffer
+         */
+        void release() noexcept;
+
+        T *buffer_;
+        size_type head_;
+        size_type tail_;
+        size_type capacity_;
+    };
+
+    template <class T>
+    mirrored_circ_buffer<T>::mirrored_circ_buffer() noexcept
+        : buffer_(nullptr),
+          head_(0),
+          tail_(0),
+          capacity_(0)
+    {
+    }
+
+    template <class T>
+    mirrored_circ_buffer<T>::mirrored_circ_buffer(size_type count)
+        : mirrored_circ_buffer()
+    {
+        // the mapping has to cover whole pages and whole elements
+        auto page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+        auto unit = page;
+        while (unit % sizeof(T) != 0)
+            unit += page;
+        // both halves have to fit into size_type after rounding up to whole units
+        const auto max_bytes = static_cast<size_type>(-1) / 2 / unit * unit;
+        if (count > max_bytes / sizeof(T))
+            throw std::length_error("mirrored_circ_buffer: count exceeds the address space");
+        auto bytes = (count * sizeof(T) + unit - 1) / unit * unit;
+        if (bytes == 0)
+            bytes = unit;
+
+        int fd = ::memfd_create("raphia::mirrored_circ_buffer", MFD_CLOEXEC);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "mirrored_circ_buffer: memfd_create failed");
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            auto err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "mirrored_circ_buffer: ftruncate failed");
+        }
+        // reserve the address range for both halves first, then map the file into each half
+        auto base = static_cast<char *>(::mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (base == MAP_FAILED)
+        {
+            auto err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "mirrored_circ_buffer: mmap failed");
+        }
+        for (auto half : {base, base + bytes})
+        {
+            if (::mmap(half, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+            {
+                auto err = errno;
+                ::munmap(base, 2 * bytes);
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "mirrored_circ_buffer: mmap failed");
+            }
+        }
+        ::close(fd);
+        buffer_ = reinterpret_cast<T *>(base);
+        capacity_ = bytes / sizeof(T);
+    }
+
+    template <class T>
+    mirrored_circ_buffer<T>::mirrored_circ_buffer(mirrored_circ_buffer &&circ) noexcept
+        : buffer_(circ.buffer_),
+          head_(circ.head_),
+          tail_(circ.tail_),
+          capacity_(circ.capacity_)
+    {
+        circ.buffer_ = nullptr;
+        circ.head_ = 0;
+        circ.tail_ = 0;
+        circ.capacity_ = 0;
+    }
+
+    template <class T>
+    mirrored_circ_buffer<T>::~mirrored_circ_buffer()
+    {
+        release();
+    }
+
+    template <class T>
+    mirrored_circ_buffer<T> &mirrored_circ_buffer<T>::operator=(mirrored_circ_buffer &&circ) noexcept
+    {
+        if (this == &circ)
+            return *this;
+        release();
+        buffer_ = circ.buffer_;
+        head_ = circ.head_;
+        tail_ = circ.tail_;
+        capacity_ = circ.capacity_;
+        circ.buffer_ = nullptr;
+        circ.head_ = 0;
+        circ.tail_ = 0;
+        circ.capacity_ = 0;
+        return *this;
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::release() noexcept
+    {
+        clear();
+        if (buffer_)
+            ::munmap(buffer_, 2 * capacity_ * sizeof(T));
+        buffer_ = nullptr;
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::iterator mirrored_circ_buffer<T>::begin() noexcept
+    {
+        return data();
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::iterator mirrored_circ_buffer<T>::end() noexcept
+    {
+        return data() + size();
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_iterator mirrored_circ_buffer<T>::cbegin() const noexcept
+    {
+        return data();
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_iterator mirrored_circ_buffer<T>::cend() const noexcept
+    {
+        return data() + size();
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::pointer mirrored_circ_buffer<T>::data() noexcept
+    {
+        return capacity_ ? buffer_ + head_ % capacity_ : buffer_;
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_pointer mirrored_circ_buffer<T>::data() const noexcept
+    {
+        return capacity_ ? buffer_ + head_ % capacity_ : buffer_;
+    }
+
+    template <class T>
+    span<T> mirrored_circ_buffer<T>::span() noexcept
+    {
+        return raphia::span<T>(data(), size());
+    }
+
+    template <class T>
+    span<const T> mirrored_circ_buffer<T>::span() const noexcept
+    {
+        return raphia::span<const T>(data(), size());
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::push_back(value_type &&a)
+    {
+        emblace_back(std::move(a));
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::push_back(const value_type &a)
+    {
+        emblace_back(a);
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::push_front(value_type &&a)
+    {
+        emblace_front(std::move(a));
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::push_front(const value_type &a)
+    {
+        emblace_front(a);
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::pop_front()
+    {
+        if (size() > 0)
+        {
+            buffer_[head_ % capacity_].~T();
+            ++head_;
+        }
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::pop_back()
+    {
+        if (size() > 0)
+        {
+            buffer_[(tail_ - 1) % capacity_].~T();
+            --tail_;
+        }
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::size_type mirrored_circ_buffer<T>::prev_head() noexcept
+    {
+        if (head_ == 0)
+        {
+            head_ += capacity_;
+            tail_ += capacity_;
+        }
+        return head_ - 1;
+    }
+
+    template <class T>
+    template <class... Args>
+    typename mirrored_circ_buffer<T>::reference mirrored_circ_buffer<T>::emblace_front(Args &&...args)
+    {
+        if (tail_ - head_ == capacity_)
+            pop_back();
+        auto new_head = prev_head();
+        auto p = new (&buffer_[new_head % capacity_]) T(std::forward<Args>(args)...);
+        head_ = new_head;
+        return *p;
+    }
+
+    template <class T>
+    template <class... Args>
+    typename mirrored_circ_buffer<T>::reference mirrored_circ_buffer<T>::emblace_back(Args &&...args)
+    {
+        if (tail_ - head_ == capacity_)
+            pop_front();
+        auto p = new (&buffer_[tail_ % capacity_]) T(std::forward<Args>(args)...);
+        ++tail_;
+        return *p;
+    }
+
+    template <class T>
+    void mirrored_circ_buffer<T>::clear() noexcept
+    {
+        while (!empty())
+            pop_back();
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::size_type mirrored_circ_buffer<T>::size() const noexcept
+    {
+        return tail_ - head_;
+    }
+
+    template <class T>
+    bool mirrored_circ_buffer<T>::empty() const noexcept
+    {
+        return tail_ == head_;
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::size_type mirrored_circ_buffer<T>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::reference mirrored_circ_buffer<T>::front()
+    {
+        if (empty())
+            throw std::underflow_error("mirrored_circ_buffer: tried to access empty container");
+        return data()[0];
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_reference mirrored_circ_buffer<T>::front() const
+    {
+        if (empty())
+            throw std::underflow_error("mirrored_circ_buffer: tried to access empty container");
+        return data()[0];
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::reference mirrored_circ_buffer<T>::back()
+    {
+        if (empty())
+            throw std::underflow_error("mirrored_circ_buffer: tried to access empty container");
+        return data()[size() - 1];
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_reference mirrored_circ_buffer<T>::back() const
+    {
+        if (empty())
+            throw std::underflow_error("mirrored_circ_buffer: tried to access empty container");
+        return data()[size() - 1];
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_reference mirrored_circ_buffer<T>::operator[](size_type idx) const noexcept
+    {
+        // no wrap around needed, the mirror continues behind the end of the buffer
+        return data()[idx];
+    }
+
+    template <class T>
+    typename mirrored_circ_buffer<T>::const_reference mirrored_circ_buffer<T>::at(size_type idx) const
+    {
+        if (idx >= size())
+            throw std::out_of_range("mirrored_circ_buffer: index out of range");
+        return data()[idx];
+    }
+} // namespace raphia
+#endif
+#endif
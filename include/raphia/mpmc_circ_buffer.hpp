@@ -0,0 +1,384 @@
+#ifndef RAPHIA_MPMC_CIRC_BUFFER_HPP
+#define RAPHIA_MPMC_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+namespace raphia
+{
+    /** mpmc_circ_buffer
+     * @brief bounded lock-free circular buffer for any number of producer and consumer threads,
+     * every slot carries a sequence number that tells whose turn it is (D. Vyukov's design).
+     * Like spsc_circ_buffer it never overwrites, pushing into a full buffer fails or blocks.
+     * A claimed slot has to be published, so nothing that may throw runs between claiming
+     * and publishing: a constructor that may throw runs on a local before the slot is claimed.
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class mpmc_circ_buffer
+    {
+        static_assert(std::is_nothrow_move_constructible<T>::value, "mpmc_circ_buffer: T must be nothrow move constructible");
+
+    public:
+        using value_type = T;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using size_type = std::size_t;
+
+        /** Constructors **/
+
+        /** mpmc_circ_buffer
+         * @brief constructor
+         * @param count buffer size, rounded according to the index policy
+         * @throw invalid_argument if count is less than 2
+         */
+        explicit mpmc_circ_buffer(size_type count, const Alloc &a = Alloc());
+
+        mpmc_circ_buffer(const mpmc_circ_buffer &) = delete;
+        mpmc_circ_buffer &operator=(const mpmc_circ_buffer &) = delete;
+
+        /** Destructor **/
+
+        /** ~mpmc_circ_buffer
+         * @brief deconstructor
+         */
+        ~mpmc_circ_buffer();
+
+        /** Producers **/
+
+        /** try_push
+         * @brief add a value to the end of the buffer
+         * @param a value to be added
+         * @return false if the buffer is full
+         */
+        bool try_push(value_type &&a);
+
+        /** try_push
+         * @brief add a value to the end of the buffer
+         * @param a value to be added
+         * @return false if the buffer is full
+         */
+        bool try_push(const value_type &a);
+
+        /** try_emplace
+         * @brief constructs a new object at the end of the buffer. If the constructor may throw,
+         * the object is constructed before the slot is claimed, and the arguments
+         * are consumed even if the buffer turns out to be full
+         * @return false if the buffer is full
+         */
+        template <class... Args>
+        bool try_emplace(Args &&...args);
+
+        /** push
+         * @brief add a value to the end of the buffer, waits while the buffer is full
+         * @param a value to be added
+         */
+        void push(value_type &&a);
+
+        /** push
+         * @brief add a value to the end of the buffer, waits while the buffer is full
+         * @param a value to be added
+         */
+        void push(const value_type &a);
+
+        /** emplace
+         * @brief constructs a new object at the end of the buffer, waits while the buffer is full
+         */
+        template <class... Args>
+        void emplace(Args &&...args);
+
+        /** Consumers **/
+
+        /** try_pop
+         * @brief move the first element out of the buffer
+         * @param a receives the element
+         * @return false if the buffer is empty
+         */
+        bool try_pop(value_type &a);
+
+        /** pop
+         * @brief move the first element out of the buffer, waits while the buffer is empty
+         * @param a receives the element
+         */
+        void pop(value_type &a);
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer,
+         * the value may be outdated as soon as it is returned
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty, see size()
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        static constexpr std::size_t cache_line = 64;
+
+        struct slot
+        {
+            std::atomic<size_type> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+            T *get() noexcept { return reinterpret_cast<T *>(&storage); }
+        };
+
+        using slot_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<slot>;
+
+        /** wait
+         * @brief back off after a failed attempt, spins first and yields the thread later on
+         */
+        static void wait(unsigned &attempt) noexcept;
+
+        /** claim
+         * @brief claim the slot at the end of the buffer, construct the object in it
+         * and publish it, constructing T from args must not throw
+         * @return false if the buffer is full
+         */
+        template <class... Args>
+        bool claim(Args &&...args) noexcept;
+
+        /** try_emplace
+         * @brief constructs the object in place, the constructor doesn't throw
+         */
+        template <class... Args>
+        bool try_emplace(std::true_type, Args &&...args) noexcept;
+
+        /** try_emplace
+         * @brief constructs the object on a local first, the constructor may throw
+         */
+        template <class... Args>
+        bool try_emplace(std::false_type, Args &&...args);
+
+        /** emplace
+         * @brief waits for a slot and constructs the object in place, the constructor doesn't throw
+         */
+        template <class... Args>
+        void emplace(std::true_type, Args &&...args) noexcept;
+
+        /** emplace
+         * @brief constructs the object on a local once, then waits for a slot, the constructor may throw
+         */
+        template <class... Args>
+        void emplace(std::false_type, Args &&...args);
+
+        alignas(cache_line) std::atomic<size_type> tail_;
+        alignas(cache_line) std::atomic<size_type> head_;
+        alignas(cache_line) Alloc alloc_;
+        slot_allocator slot_alloc_;
+        slot *slots_;
+        size_type capacity_;
+    };
+
+    template <class T, class Alloc, class Index>
+    mpmc_circ_buffer<T, Alloc, Index>::mpmc_circ_buffer(size_type count, const Alloc &a)
+        : tail_(0),
+          head_(0),
+          alloc_(a),
+          slot_alloc_(a),
+          slots_(nullptr),
+          capacity_(Index::round_capacity(count))
+    {
+        // with a single slot a filled and a free slot carry the same sequence number
+        if (capacity_ < 2)
+            throw std::invalid_argument("mpmc_circ_buffer: capacity must be at least 2");
+        slots_ = slot_alloc_.allocate(capacity_);
+        for (size_type i = 0; i < capacity_; ++i)
+        {
+            std::allocator_traits<slot_allocator>::construct(slot_alloc_, &slots_[i]);
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template <class T, class Alloc, class Index>
+    mpmc_circ_buffer<T, Alloc, Index>::~mpmc_circ_buffer()
+    {
+        for (auto pos = head_.load(std::memory_order_relaxed); pos != tail_.load(std::memory_order_relaxed); ++pos)
+            std::allocator_traits<Alloc>::destroy(alloc_, slots_[Index::index(pos, capacity_)].get());
+        for (size_type i = 0; i < capacity_; ++i)
+            std::allocator_traits<slot_allocator>::destroy(slot_alloc_, &slots_[i]);
+        slot_alloc_.deallocate(slots_, capacity_);
+    }
+
+    template <class T, class Alloc, class Index>
+    void mpmc_circ_buffer<T, Alloc, Index>::wait(unsigned &attempt) noexcept
+    {
+        if (++attempt < 64)
+            return;
+        std::this_thread::yield();
+    }
+
+    template <class T, class Alloc, class Index>
+    bool mpmc_circ_buffer<T, Alloc, Index>::try_push(value_type &&a)
+    {
+        return try_emplace(std::move(a));
+    }
+
+    template <class T, class Alloc, class Index>
+    bool mpmc_circ_buffer<T, Alloc, Index>::try_push(const value_type &a)
+    {
+        return try_emplace(a);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    bool mpmc_circ_buffer<T, Alloc, Index>::try_emplace(Args &&...args)
+    {
+        return try_emplace(std::integral_constant<bool, std::is_nothrow_constructible<T, Args &&...>::value>(), std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    bool mpmc_circ_buffer<T, Alloc, Index>::try_emplace(std::true_type, Args &&...args) noexcept
+    {
+        return claim(std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    bool mpmc_circ_buffer<T, Alloc, Index>::try_emplace(std::false_type, Args &&...args)
+    {
+        T value(std::forward<Args>(args)...);
+        return claim(std::move(value));
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    bool mpmc_circ_buffer<T, Alloc, Index>::claim(Args &&...args) noexcept
+    {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto &s = slots_[Index::index(pos, capacity_)];
+            auto sequence = s.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0)
+            {
+                // the slot is free for this lap, claim it
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    std::allocator_traits<Alloc>::construct(alloc_, s.get(), std::forward<Args>(args)...);
+                    s.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; // the slot still holds the element of the previous lap
+            else
+                pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    template <class T, class Alloc, class Index>
+    void mpmc_circ_buffer<T, Alloc, Index>::push(value_type &&a)
+    {
+        emplace(std::move(a));
+    }
+
+    template <class T, class Alloc, class Index>
+    void mpmc_circ_buffer<T, Alloc, Index>::push(const value_type &a)
+    {
+        emplace(a);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    void mpmc_circ_buffer<T, Alloc, Index>::emplace(Args &&...args)
+    {
+        emplace(std::integral_constant<bool, std::is_nothrow_constructible<T, Args &&...>::value>(), std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    void mpmc_circ_buffer<T, Alloc, Index>::emplace(std::true_type, Args &&...args) noexcept
+    {
+        // the arguments are only consumed by the attempt that succeeds
+        unsigned attempt = 0;
+        while (!claim(std::forward<Args>(args)...))
+            wait(attempt);
+    }
+
+    template <class T, class Alloc, class Index>
+    template <class... Args>
+    void mpmc_circ_buffer<T, Alloc, Index>::emplace(std::false_type, Args &&...args)
+    {
+        T value(std::forward<Args>(args)...);
+        unsigned attempt = 0;
+        while (!claim(std::move(value)))
+            wait(attempt);
+    }
+
+    template <class T, class Alloc, class Index>
+    bool mpmc_circ_buffer<T, Alloc, Index>::try_pop(value_type &a)
+    {
+        auto pos = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto &s = slots_[Index::index(pos, capacity_)];
+            auto sequence = s.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0)
+            {
+                // the slot has been filled for this lap, claim it
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    // release the slot before the assignment, which may throw
+                    T value(std::move(*s.get()));
+                    std::allocator_traits<Alloc>::destroy(alloc_, s.get());
+                    s.sequence.store(pos + capacity_, std::memory_order_release);
+                    a = std::move(value);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+                return false; // the producer of this slot hasn't finished yet
+            else
+                pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+    template <class T, class Alloc, class Index>
+    void mpmc_circ_buffer<T, Alloc, Index>::pop(value_type &a)
+    {
+        unsigned attempt = 0;
+        while (!try_pop(a))
+            wait(attempt);
+    }
+
+    template <class T, class Alloc, class Index>
+    typename mpmc_circ_buffer<T, Alloc, Index>::size_type
+    mpmc_circ_buffer<T, Alloc, Index>::size() const noexcept
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        auto tail = tail_.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(tail - head) <= 0)
+            return 0;
+        return tail - head < capacity_ ? tail - head : capacity_;
+    }
+
+    template <class T, class Alloc, class Index>
+    bool mpmc_circ_buffer<T, Alloc, Index>::empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    template <class T, class Alloc, class Index>
+    typename mpmc_circ_buffer<T, Alloc, Index>::size_type
+    mpmc_circ_buffer<T, Alloc, Index>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+} // namespace raphia
+#endif
@@ -0,0 +1,276 @@
+#ifndef RAPHIA_RECORD_CIRC_BUFFER_HPP
+#define RAPHIA_RECORD_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#include <cstdint>
+
+namespace raphia
+{
+    /** record_circ_buffer
+     * @brief circular buffer of variable length byte records, stored inline as length prefixed
+     * frames in one arena, so pushing and popping records never allocates. Like a bip buffer
+     * it keeps every record contiguous: a record that doesn't fit in front of the end of the
+     * arena starts over at the beginning, the gap left behind is skipped. A full buffer evicts
+     * whole records, oldest first, until the new one fits.
+     */
+    template <class Alloc = std::allocator<unsigned char>>
+    class record_circ_buffer
+    {
+    public:
+        using size_type = std::size_t;
+
+        /** Constructors **/
+
+        /** record_circ_buffer
+         * @brief constructor
+         * @param bytes arena size, rounded up to a multiple of record_alignment,
+         * every record takes its length plus a header of record_header bytes
+         */
+        explicit record_circ_buffer(size_type bytes, const Alloc &a = Alloc());
+
+        record_circ_buffer(const record_circ_buffer &) = delete;
+        record_circ_buffer &operator=(const record_circ_buffer &) = delete;
+
+        /** Destructor **/
+
+        /** ~record_circ_buffer
+         * @brief deconstructor
+         */
+        ~record_circ_buffer();
+
+        /** Modifiers **/
+
+        /** reserve
+         * @brief make room for a record of up to length bytes at the end of the buffer,
+         * evicting the oldest records if needed. The record is added by commit()
+         * @param length largest size of the record
+         * @return contiguous writable bytes of the record, valid until the next modification
+         * @throw length_error if the record can't fit into the arena at all
+         */
+        span<unsigned char> reserve(size_type length);
+
+        /** commit
+         * @brief add the record written to the span returned by the last reserve()
+         * @param length actual size of the record, at most the reserved length
+         */
+        void commit(size_type length) noexcept;
+
+        /** push_back
+         * @brief copy a record into the buffer, reserve() and commit() in one go
+         * @param data first byte of the record
+         * @param length size of the record
+         * @throw length_error if the record can't fit into the arena at all
+         */
+        void push_back(const void *data, size_type length);
+
+        /** pop_front
+         * @brief remove the oldest record, if any
+         */
+        void pop_front() noexcept;
+
+        /** clear
+         * @brief remove all records
+         */
+        void clear() noexcept;
+
+        /** Element Access **/
+
+        /** peek
+         * @brief the oldest record
+         * @return contiguous bytes of the record, valid until the next modification
+         * @throw underflow_error if the buffer is empty
+         */
+        span<const unsigned char> peek() const;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of records in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer holds no record
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the arena size in bytes
+         */
+        size_type capacity() const noexcept;
+
+        /** evicted
+         * @brief count of records evicted so far to make room for new ones
+         */
+        size_type evicted() const noexcept;
+
+        /** bytes needed for the length prefix of a record */
+        static constexpr size_type record_header = sizeof(std::uint32_t);
+        /** records start at multiples of record_alignment */
+        static constexpr size_type record_alignment = alignof(std::uint32_t);
+
+    private:
+        /** frame_size
+         * @brief bytes a record of length bytes takes in the arena
+         */
+        static size_type frame_size(size_type length) noexcept;
+
+        /** drop_front
+         * @brief remove the oldest record, there must be one
+         */
+        void drop_front() noexcept;
+
+        Alloc alloc_;
+        unsigned char *arena_;
+        size_type capacity_;
+        // offsets of the oldest record and the first free byte, if wrapped_ the records
+        // run from head_ to watermark_ and continue from 0 to tail_
+        size_type head_;
+        size_type tail_;
+        size_type watermark_;
+        bool wrapped_;
+        size_type count_;
+        size_type evicted_;
+    };
+
+    template <class Alloc>
+    record_circ_buffer<Alloc>::record_circ_buffer(size_type bytes, const Alloc &a)
+        : alloc_(a),
+          arena_(nullptr),
+          capacity_((bytes + record_alignment - 1) / record_alignment * record_alignment),
+          head_(0),
+          tail_(0),
+          watermark_(0),
+          wrapped_(false),
+          count_(0),
+          evicted_(0)
+    {
+        arena_ = alloc_.allocate(capacity_);
+    }
+
+    template <class Alloc>
+    record_circ_buffer<Alloc>::~record_circ_buffer()
+    {
+        alloc_.deallocate(arena_, capacity_);
+    }
+
+    template <class Alloc>
+    typename record_circ_buffer<Alloc>::size_type record_circ_buffer<Alloc>::frame_size(size_type length) noexcept
+    {
+        return (record_header + length + record_alignment - 1) / record_alignment * record_alignment;
+    }
+
+    template <class Alloc>
+    span<unsigned char> record_circ_buffer<Alloc>::reserve(size_type length)
+    {
+        if (length > static_cast<std::uint32_t>(-1) || frame_size(length) > capacity_)
+            throw std::length_error("record_circ_buffer: record exceeds the capacity");
+        auto need = frame_size(length);
+        for (;;)
+        {
+            if (count_ == 0)
+            {
+                // start over at the beginning, so the whole arena is contiguous again
+                head_ = 0;
+                tail_ = 0;
+                wrapped_ = false;
+            }
+            if (!wrapped_)
+            {
+                if (capacity_ - tail_ >= need)
+                    break;
+                // continue at the beginning, the gap behind watermark_ is skipped
+                watermark_ = tail_;
+                tail_ = 0;
+                wrapped_ = true;
+            }
+            if (head_ - tail_ >= need)
+                break;
+            drop_front();
+            ++evicted_;
+        }
+        return span<unsigned char>(arena_ + tail_ + record_header, length);
+    }
+
+    template <class Alloc>
+    void record_circ_buffer<Alloc>::commit(size_type length) noexcept
+    {
+        auto header = static_cast<std::uint32_t>(length);
+        std::memcpy(arena_ + tail_, &header, sizeof(header));
+        tail_ += frame_size(length);
+        ++count_;
+    }
+
+    template <class Alloc>
+    void record_circ_buffer<Alloc>::push_back(const void *data, size_type length)
+    {
+        auto record = reserve(length);
+        if (length)
+            std::memcpy(record.data(), data, length);
+        commit(length);
+    }
+
+    template <class Alloc>
+    void record_circ_buffer<Alloc>::pop_front() noexcept
+    {
+        if (count_ > 0)
+            drop_front();
+    }
+
+    template <class Alloc>
+    void record_circ_buffer<Alloc>::drop_front() noexcept
+    {
+        std::uint32_t length;
+        std::memcpy(&length, arena_ + head_, sizeof(length));
+        head_ += frame_size(length);
+        --count_;
+        if (wrapped_ && head_ == watermark_)
+        {
+            head_ = 0;
+            wrapped_ = false;
+        }
+    }
+
+    template <class Alloc>
+    void record_circ_buffer<Alloc>::clear() noexcept
+    {
+        head_ = 0;
+        tail_ = 0;
+        wrapped_ = false;
+        count_ = 0;
+    }
+
+    template <class Alloc>
+    span<const unsigned char> record_circ_buffer<Alloc>::peek() const
+    {
+        if (count_ == 0)
+            throw std::underflow_error("record_circ_buffer: tried to access empty buffer");
+        std::uint32_t length;
+        std::memcpy(&length, arena_ + head_, sizeof(length));
+        return span<const unsigned char>(arena_ + head_ + record_header, length);
+    }
+
+    template <class Alloc>
+    typename record_circ_buffer<Alloc>::size_type record_circ_buffer<Alloc>::size() const noexcept
+    {
+        return count_;
+    }
+
+    template <class Alloc>
+    bool record_circ_buffer<Alloc>::empty() const noexcept
+    {
+        return count_ == 0;
+    }
+
+    template <class Alloc>
+    typename record_circ_buffer<Alloc>::size_type record_circ_buffer<Alloc>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    template <class Alloc>
+    typename record_circ_buffer<Alloc>::size_type record_circ_buffer<Alloc>::evicted() const noexcept
+    {
+        return evicted_;
+    }
+} // namespace raphia
+#endif
@@ -0,0 +1,386 @@
+#ifndef RAPHIA_SHM_CIRC_BUFFER_HPP
+#define RAPHIA_SHM_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace raphia
+{
+    /** shm_circ_buffer
+     * @brief single producer single consumer ring in a POSIX shared memory segment,
+     * for passing trivially copyable elements between two processes without a copy through the kernel.
+     * The segment holds a header with the atomic counters and the slots behind it,
+     * addressed by offset, since every process maps the segment at its own address.
+     * One process creates the segment, the other one opens it by name,
+     * it is removed with remove() once neither needs it anymore.
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Index = modulo_index>
+    class shm_circ_buffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "shm_circ_buffer: T must be trivially copyable");
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shm_circ_buffer: 64 bit atomics must be lock free");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /** Constructors **/
+
+        /** shm_circ_buffer
+         * @brief creates the shared memory segment name and the buffer in it
+         * @param name name of the segment, e.g. "/feed", see shm_open
+         * @param count buffer size, rounded according to the index policy
+         * @throw system_error if the segment exists already or can't be created
+         */
+        shm_circ_buffer(const std::string &name, size_type count);
+
+        /** shm_circ_buffer
+         * @brief opens the buffer in the existing shared memory segment name
+         * @throw system_error if the segment can't be opened
+         * @throw runtime_error if the segment holds no initialized buffer of this type
+         */
+        explicit shm_circ_buffer(const std::string &name);
+
+        shm_circ_buffer(const shm_circ_buffer &) = delete;
+
+        /** shm_circ_buffer
+         * @brief move constructor
+         */
+        shm_circ_buffer(shm_circ_buffer &&) noexcept;
+
+        /** Destructor **/
+
+        /** ~shm_circ_buffer
+         * @brief unmaps the segment, the segment itself remains until remove()
+         */
+        ~shm_circ_buffer();
+
+        shm_circ_buffer &operator=(const shm_circ_buffer &) = delete;
+
+        /** remove
+         * @brief removes the shared memory segment name, processes that have it mapped keep it
+         * @return false if there was no such segment
+         */
+        static bool remove(const std::string &name) noexcept;
+
+        /** Producer **/
+
+        /** try_push
+         * @brief add a value to the end of the buffer, may only be called by the producer
+         * @param a value to be added
+         * @return false if the buffer is full
+         */
+        bool try_push(const value_type &a) noexcept;
+
+        /** push
+         * @brief add a value to the end of the buffer, waits while the buffer is full
+         * @param a value to be added
+         */
+        void push(const value_type &a) noexcept;
+
+        /** Consumer **/
+
+        /** try_pop
+         * @brief copy the first element out of the buffer, may only be called by the consumer
+         * @param a receives the element
+         * @return false if the buffer is empty
+         */
+        bool try_pop(value_type &a) noexcept;
+
+        /** pop
+         * @brief copy the first element out of the buffer, waits while the buffer is empty
+         * @param a receives the element
+         */
+        void pop(value_type &a) noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer,
+         * the value may be outdated as soon as it is returned
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty, see size()
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        static constexpr std::size_t cache_line = 64;
+        static constexpr std::uint64_t magic_number = 0x4d48535243524152; // "RARCRSHM" in little endian
+        static constexpr std::uint32_t version = 1;
+
+        struct header
+        {
+            std::atomic<std::uint64_t> magic;
+            std::uint32_t version;
+            std::uint32_t element_size;
+            std::uint64_t capacity;
+            std::uint64_t data_offset;
+            alignas(cache_line) std::atomic<std::uint64_t> head;
+            alignas(cache_line) std::atomic<std::uint64_t> tail;
+        };
+
+        /** segment_size
+         * @brief bytes needed for the header and count slots
+         */
+        static size_type segment_size(size_type count) noexcept;
+
+        /** data_offset
+         * @brief offset of the first slot in the segment
+         */
+        static constexpr size_type data_offset() noexcept
+        {
+            return (sizeof(header) + alignof(T) - 1) / alignof(T) * alignof(T);
+        }
+
+        /** map
+         * @brief map length bytes of the segment
+         */
+        void map(int fd, size_type length);
+
+        /** wait
+         * @brief back off after a failed attempt, spins first and yields the thread later on
+         */
+        static void wait(unsigned &attempt) noexcept;
+
+        header *header_;
+        T *buffer_;
+        size_type capacity_;
+        size_type length_;
+        // process local copies of the counter the other side owns
+        std::uint64_t cached_head_;
+        std::uint64_t cached_tail_;
+    };
+
+    template <class T, class Index>
+    shm_circ_buffer<T, Index>::shm_circ_buffer(const std::string &name, size_type count)
+        : header_(nullptr),
+          buffer_(nullptr),
+          capacity_(Index::round_capacity(count)),
+          length_(0),
+          cached_head_(0),
+          cached_tail_(0)
+    {
+        if (capacity_ == 0)
+            throw std::invalid_argument("shm_circ_buffer: capacity must not be 0");
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "shm_circ_buffer: shm_open failed");
+        if (::ftruncate(fd, static_cast<off_t>(segment_size(capacity_))) != 0)
+        {
+            auto err = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error(err, std::generic_category(), "shm_circ_buffer: ftruncate failed");
+        }
+        try
+        {
+            map(fd, segment_size(capacity_));
+        }
+        catch (...)
+        {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw;
+        }
+        ::close(fd);
+        // the segment is zero filled, the counters start at 0
+        header_->version = version;
+        header_->element_size = static_cast<std::uint32_t>(sizeof(T));
+        header_->capacity = capacity_;
+        header_->data_offset = data_offset();
+        new (&header_->head) std::atomic<std::uint64_t>(0);
+        new (&header_->tail) std::atomic<std::uint64_t>(0);
+        buffer_ = reinterpret_cast<T *>(reinterpret_cast<char *>(header_) + data_offset());
+        // publishes the header to the process that opens the segment
+        header_->magic.store(magic_number, std::memory_order_release);
+    }
+
+    template <class T, class Index>
+    shm_circ_buffer<T, Index>::shm_circ_buffer(const std::string &name)
+        : header_(nullptr),
+          buffer_(nullptr),
+          capacity_(0),
+          length_(0),
+          cached_head_(0),
+          cached_tail_(0)
+    {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "shm_circ_buffer: shm_open failed");
+        try
+        {
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+                throw std::system_error(errno, std::generic_category(), "shm_circ_buffer: fstat failed");
+            auto size = static_cast<size_type>(st.st_size);
+            if (size < sizeof(header))
+                throw std::runtime_error("shm_circ_buffer: the segment holds no initialized buffer");
+            map(fd, sizeof(header));
+            bool valid = header_->magic.load(std::memory_order_acquire) == magic_number && header_->version == version &&
+                         header_->element_size == sizeof(T) && header_->data_offset == data_offset() &&
+                         header_->capacity > 0 && size >= segment_size(static_cast<size_type>(header_->capacity)) &&
+                         header_->capacity == Index::round_capacity(static_cast<size_type>(header_->capacity));
+            auto capacity = static_cast<size_type>(header_->capacity);
+            ::munmap(header_, length_);
+            header_ = nullptr;
+            if (!valid)
+                throw std::runtime_error("shm_circ_buffer: the segment holds no initialized buffer of this type");
+            map(fd, segment_size(capacity));
+            capacity_ = capacity;
+        }
+        catch (...)
+        {
+            if (header_)
+                ::munmap(header_, length_);
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        buffer_ = reinterpret_cast<T *>(reinterpret_cast<char *>(header_) + header_->data_offset);
+        cached_head_ = header_->head.load(std::memory_order_acquire);
+        cached_tail_ = header_->tail.load(std::memory_order_acquire);
+    }
+
+    template <class T, class Index>
+    shm_circ_buffer<T, Index>::shm_circ_buffer(shm_circ_buffer &&circ) noexcept
+        : header_(circ.header_),
+          buffer_(circ.buffer_),
+          capacity_(circ.capacity_),
+          length_(circ.length_),
+          cached_head_(circ.cached_head_),
+          cached_tail_(circ.cached_tail_)
+    {
+        circ.header_ = nullptr;
+        circ.buffer_ = nullptr;
+        circ.capacity_ = 0;
+        circ.length_ = 0;
+    }
+
+    template <class T, class Index>
+    shm_circ_buffer<T, Index>::~shm_circ_buffer()
+    {
+        if (header_)
+            ::munmap(header_, length_);
+    }
+
+    template <class T, class Index>
+    bool shm_circ_buffer<T, Index>::remove(const std::string &name) noexcept
+    {
+        return ::shm_unlink(name.c_str()) == 0;
+    }
+
+    template <class T, class Index>
+    typename shm_circ_buffer<T, Index>::size_type shm_circ_buffer<T, Index>::segment_size(size_type count) noexcept
+    {
+        return data_offset() + count * sizeof(T);
+    }
+
+    template <class T, class Index>
+    void shm_circ_buffer<T, Index>::map(int fd, size_type length)
+    {
+        auto p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "shm_circ_buffer: mmap failed");
+        header_ = static_cast<header *>(p);
+        length_ = length;
+    }
+
+    template <class T, class Index>
+    void shm_circ_buffer<T, Index>::wait(unsigned &attempt) noexcept
+    {
+        if (++attempt < 64)
+            return;
+        std::this_thread::yield();
+    }
+
+    template <class T, class Index>
+    bool shm_circ_buffer<T, Index>::try_push(const value_type &a) noexcept
+    {
+        auto tail = header_->tail.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_)
+        {
+            cached_head_ = header_->head.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_)
+                return false;
+        }
+        std::memcpy(&buffer_[Index::index(static_cast<size_type>(tail), capacity_)], &a, sizeof(T));
+        header_->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T, class Index>
+    void shm_circ_buffer<T, Index>::push(const value_type &a) noexcept
+    {
+        unsigned attempt = 0;
+        while (!try_push(a))
+            wait(attempt);
+    }
+
+    template <class T, class Index>
+    bool shm_circ_buffer<T, Index>::try_pop(value_type &a) noexcept
+    {
+        auto head = header_->head.load(std::memory_order_relaxed);
+        if (head == cached_tail_)
+        {
+            cached_tail_ = header_->tail.load(std::memory_order_acquire);
+            if (head == cached_tail_)
+                return false;
+        }
+        std::memcpy(&a, &buffer_[Index::index(static_cast<size_type>(head), capacity_)], sizeof(T));
+        header_->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T, class Index>
+    void shm_circ_buffer<T, Index>::pop(value_type &a) noexcept
+    {
+        unsigned attempt = 0;
+        while (!try_pop(a))
+            wait(attempt);
+    }
+
+    template <class T, class Index>
+    typename shm_circ_buffer<T, Index>::size_type shm_circ_buffer<T, Index>::size() const noexcept
+    {
+        auto head = header_->head.load(std::memory_order_acquire);
+        auto tail = header_->tail.load(std::memory_order_acquire);
+        if (static_cast<std::int64_t>(tail - head) <= 0)
+            return 0;
+        return tail - head < capacity_ ? static_cast<size_type>(tail - head) : capacity_;
+    }
+
+    template <class T, class Index>
+    bool shm_circ_buffer<T, Index>::empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    template <class T, class Index>
+    typename shm_circ_buffer<T, Index>::size_type shm_circ_buffer<T, Index>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+} // namespace raphia
+#endif
+#endif
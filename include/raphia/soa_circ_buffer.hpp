@@ -0,0 +1,550 @@
+#ifndef RAPHIA_SOA_CIRC_BUFFER_HPP
+#define RAPHIA_SOA_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#include <tuple>
+#include <utility>
+
+namespace raphia
+{
+    namespace detail
+    {
+        template <bool...>
+        struct bool_pack;
+
+        /** all_true
+         * @brief true if every one of Bs is true
+         */
+        template <bool... Bs>
+        using all_true = std::is_same<bool_pack<true, Bs...>, bool_pack<Bs..., true>>;
+    } // namespace detail
+
+    /** basic_soa_circ_buffer
+     * @brief circular buffer of records stored as a structure of arrays, one column per
+     * field type, all sharing one head_ and tail_. A scan over one field only pulls that
+     * column through the cache. Columns start at a cache line boundary and are exposed
+     * as at most two contiguous segments, like circ_buffer::readable_segments.
+     * push_back overwrites the oldest record of a full buffer, like circ_buffer::push_back.
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     * @tparam Ts column types, trivially copyable
+     */
+    template <class Index, class... Ts>
+    class basic_soa_circ_buffer
+    {
+        static_assert(sizeof...(Ts) > 0, "soa_circ_buffer: at least one column is needed");
+        static_assert(detail::all_true<std::is_trivially_copyable<Ts>::value...>::value, "soa_circ_buffer: columns must be trivially copyable");
+
+    public:
+        using value_type = std::tuple<Ts...>;
+        using size_type = std::size_t;
+
+        template <std::size_t I>
+        using column_type = typename std::tuple_element<I, value_type>::type;
+
+        template <std::size_t I>
+        using column_segments = std::array<span<column_type<I>>, 2>;
+
+        template <std::size_t I>
+        using const_column_segments = std::array<span<const column_type<I>>, 2>;
+
+        /** Constructors **/
+
+        /** basic_soa_circ_buffer
+         * @brief constructor
+         * @param count buffer size in records, rounded according to the index policy
+         */
+        explicit basic_soa_circ_buffer(size_type count = 0);
+
+        /** basic_soa_circ_buffer
+         * @brief copy constructor, copies the live records only
+         */
+        basic_soa_circ_buffer(const basic_soa_circ_buffer &);
+
+        /** basic_soa_circ_buffer
+         * @brief move constructor
+         */
+        basic_soa_circ_buffer(basic_soa_circ_buffer &&) noexcept;
+
+        /** Destructor **/
+
+        /** ~basic_soa_circ_buffer
+         * @brief deconstructor
+         */
+        ~basic_soa_circ_buffer();
+
+        /** Assignment **/
+
+        /** operator=
+         * @brief copy assignment operator
+         */
+        basic_soa_circ_buffer &operator=(const basic_soa_circ_buffer &);
+
+        /** operator=
+         * @brief move assignment operator
+         */
+        basic_soa_circ_buffer &operator=(basic_soa_circ_buffer &&) noexcept;
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a record to the end of the buffer, if the buffer is full,
+         * the first record is overwritten
+         * @param values one value per column
+         */
+        void push_back(const Ts &...values) noexcept;
+
+        /** push_back
+         * @brief add a record to the end of the buffer, if the buffer is full,
+         * the first record is overwritten
+         * @param record one value per column
+         */
+        void push_back(const value_type &record) noexcept;
+
+        /** pop_front
+         * @brief remove the first record, if any
+         */
+        void pop_front() noexcept;
+
+        /** pop_front
+         * @brief remove the first count records, or all records if there are less
+         */
+        void pop_front(size_type count) noexcept;
+
+        /** clear
+         * @brief remove all records
+         */
+        void clear() noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of records in the buffer
+         * @return current record count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity in records
+         * @return buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+        /** Element Access **/
+
+        /** get
+         * @brief access a field of a record
+         * @tparam I column index
+         * @param pos position of the record, counting from the first one
+         */
+        template <std::size_t I>
+        column_type<I> &get(size_type pos) noexcept;
+
+        /** get
+         * @brief access a field of a record
+         * @tparam I column index
+         * @param pos position of the record, counting from the first one
+         */
+        template <std::size_t I>
+        const column_type<I> &get(size_type pos) const noexcept;
+
+        /** operator[]
+         * @brief gather a whole record
+         * @param pos position of the record, counting from the first one
+         */
+        value_type operator[](size_type pos) const noexcept;
+
+        /** at
+         * @brief gather a whole record, with bounds checking
+         * @throw out_of_range if pos is not below size()
+         */
+        value_type at(size_type pos) const;
+
+        /** front
+         * @brief gather the first record
+         * @throw underflow_error if the buffer is empty
+         */
+        value_type front() const;
+
+        /** back
+         * @brief gather the last record
+         * @throw underflow_error if the buffer is empty
+         */
+        value_type back() const;
+
+        /** Column Access **/
+
+        /** segments
+         * @brief the contiguous parts (at most two) of column I, oldest records first
+         */
+        template <std::size_t I>
+        column_segments<I> segments() noexcept;
+
+        /** segments
+         * @brief the contiguous parts (at most two) of column I, oldest records first
+         */
+        template <std::size_t I>
+        const_column_segments<I> segments() const noexcept;
+
+        /** for_each
+         * @brief call f(value) for every value of column I, oldest first,
+         * as one flat loop per segment that the compiler can vectorize
+         * @return f
+         */
+        template <std::size_t I, class Func>
+        Func for_each(Func f) const;
+
+    private:
+        using columns_type = std::tuple<Ts *...>;
+        using indices = std::index_sequence_for<Ts...>;
+
+        template <class T>
+        using column_allocator = cache_aligned_allocator<T>;
+
+        /** allocate
+         * @brief allocate every column with capacity_ slots
+         */
+        template <std::size_t... Is>
+        void allocate(std::index_sequence<Is...>);
+
+        /** deallocate
+         * @brief release every column
+         */
+        template <std::size_t... Is>
+        void deallocate(std::index_sequence<Is...>) noexcept;
+
+        /** push
+         * @brief push_back for a tuple with one value per column
+         */
+        template <class Tuple>
+        void push(const Tuple &record) noexcept;
+
+        /** write
+         * @brief store a record, a tuple with one value per column, at slot
+         */
+        template <class Tuple, std::size_t... Is>
+        void write(size_type slot, const Tuple &record, std::index_sequence<Is...>) noexcept;
+
+        /** read
+         * @brief gather the record at slot
+         */
+        template <std::size_t... Is>
+        value_type read(size_type slot, std::index_sequence<Is...>) const noexcept;
+
+        /** copy_columns
+         * @brief copy the live records of circ to slot 0 onwards, one block per segment and column
+         */
+        template <std::size_t... Is>
+        void copy_columns(const basic_soa_circ_buffer &circ, std::index_sequence<Is...>) noexcept;
+
+        /** copy_column
+         * @brief copy the live records of column I of circ to slot 0 onwards
+         */
+        template <std::size_t I>
+        void copy_column(const basic_soa_circ_buffer &circ) noexcept;
+
+        columns_type columns_;
+        size_type head_;
+        size_type tail_;
+        size_type capacity_;
+    };
+
+    /** soa_circ_buffer
+     * @brief basic_soa_circ_buffer with the default index policy, e.g.
+     * soa_circ_buffer<std::int64_t, double, std::uint32_t, std::uint8_t> for timestamp, price, qty and flags
+     */
+    template <class... Ts>
+    using soa_circ_buffer = basic_soa_circ_buffer<modulo_index, Ts...>;
+
+    template <class Index, class... Ts>
+    basic_soa_circ_buffer<Index, Ts...>::basic_soa_circ_buffer(size_type count)
+        : columns_(),
+          head_(0),
+          tail_(0),
+          capacity_(Index::round_capacity(count))
+    {
+        allocate(indices());
+    }
+
+    template <class Index, class... Ts>
+    basic_soa_circ_buffer<Index, Ts...>::basic_soa_circ_buffer(const basic_soa_circ_buffer &circ)
+        : columns_(),
+          head_(0),
+          tail_(0),
+          capacity_(circ.capacity_)
+    {
+        allocate(indices());
+        copy_columns(circ, indices());
+    }
+
+    template <class Index, class... Ts>
+    basic_soa_circ_buffer<Index, Ts...>::basic_soa_circ_buffer(basic_soa_circ_buffer &&circ) noexcept
+        : columns_(circ.columns_),
+          head_(circ.head_),
+          tail_(circ.tail_),
+          capacity_(circ.capacity_)
+    {
+        circ.columns_ = columns_type();
+        circ.head_ = 0;
+        circ.tail_ = 0;
+        circ.capacity_ = 0;
+    }
+
+    template <class Index, class... Ts>
+    basic_soa_circ_buffer<Index, Ts...>::~basic_soa_circ_buffer()
+    {
+        deallocate(indices());
+    }
+
+    template <class Index, class... Ts>
+    basic_soa_circ_buffer<Index, Ts...> &basic_soa_circ_buffer<Index, Ts...>::operator=(const basic_soa_circ_buffer &circ)
+    {
+        if (this == &circ)
+            return *this;
+        if (capacity_ != circ.capacity_)
+        {
+            basic_soa_circ_buffer copy(circ);
+            return *this = std::move(copy);
+        }
+        clear();
+        copy_columns(circ, indices());
+        return *this;
+    }
+
+    template <class Index, class... Ts>
+    basic_soa_circ_buffer<Index, Ts...> &basic_soa_circ_buffer<Index, Ts...>::operator=(basic_soa_circ_buffer &&circ) noexcept
+    {
+        if (this == &circ)
+            return *this;
+        deallocate(indices());
+        columns_ = circ.columns_;
+        head_ = circ.head_;
+        tail_ = circ.tail_;
+        capacity_ = circ.capacity_;
+        circ.columns_ = columns_type();
+        circ.head_ = 0;
+        circ.tail_ = 0;
+        circ.capacity_ = 0;
+        return *this;
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t... Is>
+    void basic_soa_circ_buffer<Index, Ts...>::allocate(std::index_sequence<Is...>)
+    {
+        try
+        {
+            using expand = int[];
+            (void)expand{0, (std::get<Is>(columns_) = column_allocator<column_type<Is>>().allocate(capacity_), 0)...};
+        }
+        catch (...)
+        {
+            deallocate(indices());
+            throw;
+        }
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t... Is>
+    void basic_soa_circ_buffer<Index, Ts...>::deallocate(std::index_sequence<Is...>) noexcept
+    {
+        // columns that were never allocated are nullptr, which deallocate ignores
+        using expand = int[];
+        (void)expand{0, (column_allocator<column_type<Is>>().deallocate(std::get<Is>(columns_), capacity_), 0)...};
+    }
+
+    template <class Index, class... Ts>
+    template <class Tuple, std::size_t... Is>
+    void basic_soa_circ_buffer<Index, Ts...>::write(size_type slot, const Tuple &record, std::index_sequence<Is...>) noexcept
+    {
+        using expand = int[];
+        (void)expand{0, (std::get<Is>(columns_)[slot] = std::get<Is>(record), 0)...};
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t... Is>
+    typename basic_soa_circ_buffer<Index, Ts...>::value_type
+    basic_soa_circ_buffer<Index, Ts...>::read(size_type slot, std::index_sequence<Is...>) const noexcept
+    {
+        return value_type(std::get<Is>(columns_)[slot]...);
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t... Is>
+    void basic_soa_circ_buffer<Index, Ts...>::copy_columns(const basic_soa_circ_buffer &circ, std::index_sequence<Is...>) noexcept
+    {
+        using expand = int[];
+        (void)expand{0, (copy_column<Is>(circ), 0)...};
+        head_ = 0;
+        tail_ = circ.size();
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t I>
+    void basic_soa_circ_buffer<Index, Ts...>::copy_column(const basic_soa_circ_buffer &circ) noexcept
+    {
+        auto dest = std::get<I>(columns_);
+        for (auto &segment : circ.template segments<I>())
+        {
+            if (segment.size())
+                std::memcpy(dest, segment.data(), segment.size_bytes());
+            dest += segment.size();
+        }
+    }
+
+    template <class Index, class... Ts>
+    void basic_soa_circ_buffer<Index, Ts...>::push_back(const Ts &...values) noexcept
+    {
+        push(std::tie(values...));
+    }
+
+    template <class Index, class... Ts>
+    void basic_soa_circ_buffer<Index, Ts...>::push_back(const value_type &record) noexcept
+    {
+        push(record);
+    }
+
+    template <class Index, class... Ts>
+    template <class Tuple>
+    void basic_soa_circ_buffer<Index, Ts...>::push(const Tuple &record) noexcept
+    {
+        // the counters are kept in locals, a store into a char column
+        // would force the compiler to load them again
+        auto tail = tail_;
+        auto capacity = capacity_;
+        if (capacity == 0)
+            return;
+        if (tail - head_ == capacity)
+            ++head_;
+        write(Index::index(tail, capacity), record, indices());
+        tail_ = tail + 1;
+    }
+
+    template <class Index, class... Ts>
+    void basic_soa_circ_buffer<Index, Ts...>::pop_front() noexcept
+    {
+        if (!empty())
+            ++head_;
+    }
+
+    template <class Index, class... Ts>
+    void basic_soa_circ_buffer<Index, Ts...>::pop_front(size_type count) noexcept
+    {
+        head_ += count < size() ? count : size();
+    }
+
+    template <class Index, class... Ts>
+    void basic_soa_circ_buffer<Index, Ts...>::clear() noexcept
+    {
+        head_ = 0;
+        tail_ = 0;
+    }
+
+    template <class Index, class... Ts>
+    typename basic_soa_circ_buffer<Index, Ts...>::size_type basic_soa_circ_buffer<Index, Ts...>::size() const noexcept
+    {
+        return tail_ - head_;
+    }
+
+    template <class Index, class... Ts>
+    bool basic_soa_circ_buffer<Index, Ts...>::empty() const noexcept
+    {
+        return tail_ == head_;
+    }
+
+    template <class Index, class... Ts>
+    typename basic_soa_circ_buffer<Index, Ts...>::size_type basic_soa_circ_buffer<Index, Ts...>::capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t I>
+    typename basic_soa_circ_buffer<Index, Ts...>::template column_type<I> &
+    basic_soa_circ_buffer<Index, Ts...>::get(size_type pos) noexcept
+    {
+        return std::get<I>(columns_)[Index::index(head_ + pos, capacity_)];
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t I>
+    const typename basic_soa_circ_buffer<Index, Ts...>::template column_type<I> &
+    basic_soa_circ_buffer<Index, Ts...>::get(size_type pos) const noexcept
+    {
+        return std::get<I>(columns_)[Index::index(head_ + pos, capacity_)];
+    }
+
+    template <class Index, class... Ts>
+    typename basic_soa_circ_buffer<Index, Ts...>::value_type
+    basic_soa_circ_buffer<Index, Ts...>::operator[](size_type pos) const noexcept
+    {
+        return read(Index::index(head_ + pos, capacity_), indices());
+    }
+
+    template <class Index, class... Ts>
+    typename basic_soa_circ_buffer<Index, Ts...>::value_type basic_soa_circ_buffer<Index, Ts...>::at(size_type pos) const
+    {
+        if (pos >= size())
+            throw std::out_of_range("soa_circ_buffer: index out of range");
+        return (*this)[pos];
+    }
+
+    template <class Index, class... Ts>
+    typename basic_soa_circ_buffer<Index, Ts...>::value_type basic_soa_circ_buffer<Index, Ts...>::front() const
+    {
+        if (empty())
+            throw std::underflow_error("soa_circ_buffer: tried to access empty buffer");
+        return (*this)[0];
+    }
+
+    template <class Index, class... Ts>
+    typename basic_soa_circ_buffer<Index, Ts...>::value_type basic_soa_circ_buffer<Index, Ts...>::back() const
+    {
+        if (empty())
+            throw std::underflow_error("soa_circ_buffer: tried to access empty buffer");
+        return (*this)[size() - 1];
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t I>
+    typename basic_soa_circ_buffer<Index, Ts...>::template column_segments<I>
+    basic_soa_circ_buffer<Index, Ts...>::segments() noexcept
+    {
+        using T = column_type<I>;
+        if (empty())
+            return column_segments<I>();
+        auto column = std::get<I>(columns_);
+        auto first = Index::index(head_, capacity_);
+        auto count = size();
+        auto count_one = count < capacity_ - first ? count : capacity_ - first;
+        return {{span<T>(column + first, count_one), span<T>(column, count - count_one)}};
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t I>
+    typename basic_soa_circ_buffer<Index, Ts...>::template const_column_segments<I>
+    basic_soa_circ_buffer<Index, Ts...>::segments() const noexcept
+    {
+        using T = const column_type<I>;
+        auto s = const_cast<basic_soa_circ_buffer *>(this)->template segments<I>();
+        return {{span<T>(s[0].data(), s[0].size()), span<T>(s[1].data(), s[1].size())}};
+    }
+
+    template <class Index, class... Ts>
+    template <std::size_t I, class Func>
+    Func basic_soa_circ_buffer<Index, Ts...>::for_each(Func f) const
+    {
+        for (auto &segment : segments<I>())
+        {
+            auto p = segment.data();
+            for (size_type i = 0, n = segment.size(); i < n; ++i)
+                f(p[i]);
+        }
+        return f;
+    }
+} // namespace raphia
+#endif
@@ -0,0 +1,893 @@
+#ifndef RAPHIA_STATIC_CIRC_BUFFER_HPP
+#define RAPHIA_STATIC_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+
+namespace raphia
+{
+    /** static_circ_buffer
+     * @brief circ_buffer with a compile time capacity and inline storage,
+     * no allocation and no pointer, so it can be placed in shared memory
+     * (given T can) or constructed with placement new
+     * @tparam N capacity, powers of two turn the slot computation into a mask
+     * @tparam Index policy mapping the free running counters onto buffer slots,
+     * pow2_index requires N to be a power of two and lets the counters wrap
+     */
+    template <class T, std::size_t N, class Index = modulo_index>
+    class static_circ_buffer
+    {
+        static_assert(N > 0, "static_circ_buffer: capacity must not be 0");
+        static_assert(!Index::wraps || (N & (N - 1)) == 0, "static_circ_buffer: the index policy requires a power of two capacity");
+
+    public:
+        using size_type = std::size_t;
+
+        /** basic_iterator
+         * @brief random access iterator
+         */
+        template <class Container, class ValueType>
+        struct basic_iterator
+        {
+            using iterator_category = std::random_access_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = typename std::remove_const<ValueType>::type;
+            using pointer = ValueType *;
+            using reference = ValueType &;
+            using container = Container;
+
+            basic_iterator() noexcept
+                : offset_(0), circ_(nullptr) {}
+
+            basic_iterator(difference_type offset, container &circ_buffer) noexcept
+                : offset_(offset), circ_(&circ_buffer) {}
+
+            /** basic_iterator
+             * @brief converts an iterator into a const_iterator
+             */
+            template <class C, class V, class = typename std::enable_if<std::is_convertible<V *, ValueType *>::value>::type>
+            basic_iterator(const basic_iterator<C, V> &it) noexcept
+                : offset_(it.offset_), circ_(it.circ_) {}
+
+            reference operator*() const;
+            pointer operator->() const;
+            reference operator[](difference_type n) const;
+            basic_iterator &operator++();
+            basic_iterator operator++(int);
+            basic_iterator &operator--();
+            basic_iterator operator--(int);
+            basic_iterator &operator+=(difference_type n);
+            basic_iterator &operator-=(difference_type n);
+            basic_iterator operator+(difference_type n) const;
+            basic_iterator operator-(difference_type n) const;
+            typename basic_iterator::difference_type operator-(const basic_iterator &it) const;
+
+            /** segment
+             * @brief the contiguous elements from this iterator up to last
+             * or up to the end of the buffer, whatever comes first
+             */
+            span<ValueType> segment(const basic_iterator &last) const;
+
+            friend basic_iterator operator+(difference_type n, const basic_iterator &it) { return it + n; }
+            friend bool operator==(const basic_iterator &a, const basic_iterator &b) { return a.offset_ == b.offset_; };
+            friend bool operator!=(const basic_iterator &a, const basic_iterator &b) { return a.offset_ != b.offset_; };
+            friend bool operator<(const basic_iterator &a, const basic_iterator &b) { return a.offset_ < b.offset_; };
+            friend bool operator>(const basic_iterator &a, const basic_iterator &b) { return a.offset_ > b.offset_; };
+            friend bool operator<=(const basic_iterator &a, const basic_iterator &b) { return a.offset_ <= b.offset_; };
+            friend bool operator>=(const basic_iterator &a, const basic_iterator &b) { return a.offset_ >= b.offset_; };
+
+        private:
+            template <class, class>
+            friend struct basic_iterator;
+
+            difference_type offset_;
+            container *circ_;
+        };
+
+        using value_type = T;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using iterator = basic_iterator<static_circ_buffer<T, N, Index>, T>;
+        using const_iterator = basic_iterator<const static_circ_buffer<T, N, Index>, const T>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using segments = std::array<span<T>, 2>;
+        using const_segments = std::array<span<const T>, 2>;
+
+        /** Constructors **/
+
+        /** static_circ_buffer
+         * @brief default constructor
+         */
+        static_circ_buffer() noexcept;
+
+        /** static_circ_buffer
+         * @brief construct container from a range, only the last N values are kept
+         */
+        template <class Iter, class = typename std::iterator_traits<Iter>::iterator_category>
+        static_circ_buffer(Iter begin, Iter end);
+
+        /** static_circ_buffer
+         * @brief copy constructor
+         */
+        static_circ_buffer(const static_circ_buffer &);
+
+        /** static_circ_buffer
+         * @brief move constructor, moves the elements one by one
+         */
+        static_circ_buffer(static_circ_buffer &&) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+        /** Destructor **/
+
+        /** ~static_circ_buffer
+         * @brief deconstructor
+         */
+        ~static_circ_buffer();
+
+        /** Copy/Move operators **/
+
+        /** operator=
+         * @brief copy operator
+         */
+        static_circ_buffer &operator=(const static_circ_buffer &);
+
+        /** operator=
+         * @brief move operator, moves the elements one by one
+         */
+        static_circ_buffer &operator=(static_circ_buffer &&) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+        /** Iterators **/
+
+        /** begin
+         * @brief retrieves an iterator the first element
+         * @return iterator to the first element
+         */
+        iterator begin() noexcept;
+
+        /** end
+         * @brief retrieves an iterator the last element
+         * @return iterator to the last element
+         */
+        iterator end() noexcept;
+
+        /** begin
+         * @brief retrieves a constant iterator the first element
+         * @return constant iterator to the first element
+         */
+        const_iterator begin() const noexcept;
+
+        /** end
+         * @brief retrieves a constant iterator the last element
+         * @return constant iterator to the last element
+         */
+        const_iterator end() const noexcept;
+
+        /** cbegin
+         * @brief retrieves a constant iterator the first element
+         * @return constant iterator to the first element
+         */
+        const_iterator cbegin() const noexcept;
+
+        /** cend
+         * @brief retrieves a constant iterator the last element
+         * @return constant iterator to the last element
+         */
+        const_iterator cend() const noexcept;
+
+        /** rbegin
+         * @brief retrieves a reverse iterator to the last element
+         * @return reverse iterator to the last element
+         */
+        reverse_iterator rbegin() noexcept;
+
+        /** rend
+         * @brief retrieves a reverse iterator in front of the first element
+         * @return reverse iterator in front of the first element
+         */
+        reverse_iterator rend() noexcept;
+
+        /** crbegin
+         * @brief retrieves a constant reverse iterator to the last element
+         * @return constant reverse iterator to the last element
+         */
+        const_reverse_iterator crbegin() const noexcept;
+
+        /** crend
+         * @brief retrieves a constant reverse iterator in front of the first element
+         * @return constant reverse iterator in front of the first element
+         */
+        const_reverse_iterator crend() const noexcept;
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a value to the end of the circular buffer,
+         * if the buffer is full, the first element will be overwritten
+         * @param a value to be added
+         */
+        void push_back(value_type &&a);
+
+        /** push_back
+         * @brief add a value to the end of the circular buffer,
+         * if the buffer is full, the first element will be overwritten
+         * @param a value to be added
+         */
+        void push_back(const value_type &a);
+
+        /** push_front
+         * @brief add a value to the front of the circular buffer,
+         * if the buffer is full, the last element will be overwritten
+         * @param a value to be added
+         */
+        void push_front(value_type &&a);
+
+        /** push_front
+         * @brief push a value to the front of the circular buffer,
+         * if the buffer is full, the last element will be overwritten
+         * @param a value to be added
+         */
+        void push_front(const value_type &a);
+
+        /** pop_front
+         * @brief remove the first element from the buffer
+         */
+        void pop_front();
+
+        /** pop_back
+         * @brief remove the last element from the buffer
+         */
+        void pop_back();
+
+        /** push_back
+         * @brief add a range of values to the end of the circular buffer,
+         * if the buffer runs out of space, the first elements will be overwritten
+         * @param first begin of the range
+         * @param last end of the range
+         */
+        template <class Iter, class = typename std::iterator_traits<Iter>::iterator_category>
+        void push_back(Iter first, Iter last);
+
+        /** pop_front
+         * @brief remove elements from the front of the buffer
+         * @param count number of elements to remove, limited to the buffer size
+         */
+        void pop_front(size_type count) noexcept;
+
+        /** copy_out
+         * @brief copy elements from the front of the buffer without removing them
+         * @param dest destination of the elements
+         * @param count number of elements to copy, limited to the buffer size
+         * @return iterator behind the last copied element
+         */
+        template <class OutIter>
+        OutIter copy_out(OutIter dest, size_type count) const;
+
+        /** emblace_front
+         * @brief constructs a new object at the front of the buffer
+         * @returns a reference to the newly constructed object
+         */
+        template <class... Args>
+        reference emblace_front(Args &&...args);
+
+        /** emblace_back
+         * @brief constructs a new object at the back of the buffer
+         * @returns a reference to the newly constructed object
+         */
+        template <class... Args>
+        reference emblace_back(Args &&...args);
+
+        /** clear
+         * @brief clear the buffer
+         */
+        void clear() noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer
+         * @return current element count in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty
+         * @return true if buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         * @return N
+         */
+        static constexpr size_type capacity() noexcept { return N; }
+
+        /** Accessors **/
+
+        /** front
+         * @brief access the first element in the buffer
+         * @return reference to the first element
+         * @throw underflow_error if the buffer is empty
+         */
+        reference front();
+
+        /** front
+         * @brief access the first element in the buffer
+         * @return const reference to the first element
+         * @throw underflow_error if the buffer is empty
+         */
+        const_reference front() const;
+
+        /** back
+         * @brief access the last element in the buffer
+         * @return reference to the last element
+         * @throw underflow_error if the buffer is empty
+         */
+        reference back();
+
+        /** back
+         * @brief access the last element in the buffer
+         * @return const reference to the last element
+         * @throw underflow_error if the buffer is empty
+         */
+        const_reference back() const;
+
+        /** operator[]
+         * @brief access an element by index
+         * @return const reference to the element at the given index
+         */
+        const_reference operator[](size_type idx) const noexcept;
+
+        /** at
+         * @brief access an element by index
+         * @return const reference to the element at the given index
+         * @throw out_of_range exception if the index lies not in the buffer range
+         */
+        const_reference at(size_type idx) const;
+
+        /** Segments **/
+
+        /** array_one
+         * @brief the first contiguous part of the elements, starting with the first element
+         */
+        span<T> array_one() noexcept;
+
+        /** array_one
+         * @brief the first contiguous part of the elements, starting with the first element
+         */
+        span<const T> array_one() const noexcept;
+
+        /** array_two
+         * @brief the second contiguous part of the elements, starting at the beginning of the buffer
+         */
+        span<T> array_two() noexcept;
+
+        /** array_two
+         * @brief the second contiguous part of the elements, starting at the beginning of the buffer
+         */
+        span<const T> array_two() const noexcept;
+
+        /** readable_segments
+         * @brief all elements as at most two contiguous parts, see array_one() and array_two()
+         */
+        segments readable_segments() noexcept;
+
+        /** readable_segments
+         * @brief all elements as at most two contiguous parts, see array_one() and array_two()
+         */
+        const_segments readable_segments() const noexcept;
+
+        /** prepare
+         * @brief get the free slots behind the last element as at most two contiguous parts.
+         * Only for trivially copyable types.
+         * @param count number of slots wanted, less are returned if the buffer has less free slots
+         */
+        segments prepare(size_type count) noexcept;
+
+        /** commit
+         * @brief add elements that have been written to the segments returned by prepare()
+         * @param count number of elements to add, limited to the free slots
+         */
+        void commit(size_type count) noexcept;
+
+        /** consume
+         * @brief remove elements from the front
+         * @param count number of elements to remove, limited to the buffer size
+         */
+        void consume(size_type count) noexcept;
+
+    private:
+        /** slot
+         * @brief element storage for a counter position, N is a constant so the
+         * index policy folds into a mask or a multiplication
+         */
+        T *slot(size_type pos) noexcept { return data() + Index::index(pos, N); }
+        const T *slot(size_type pos) const noexcept { return data() + Index::index(pos, N); }
+
+        T *data() noexcept { return reinterpret_cast<T *>(&storage_); }
+        const T *data() const noexcept { return reinterpret_cast<const T *>(&storage_); }
+
+        /** prev_head
+         * @brief counter position in front of the head, rebases the counters before they wrap
+         */
+        size_type prev_head() noexcept;
+
+        size_type head_;
+        size_type tail_;
+        typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage_;
+    };
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>::reference
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator*() const
+    {
+        return *circ_->slot(circ_->head_ + static_cast<size_type>(offset_));
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>::pointer
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator->() const
+    {
+        return &**this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>::reference
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator[](difference_type n) const
+    {
+        return *(*this + n);
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType> &
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator++()
+    {
+        ++offset_;
+        return *this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator++(int)
+    {
+        basic_iterator tmp = *this;
+        ++offset_;
+        return tmp;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType> &
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator--()
+    {
+        --offset_;
+        return *this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator--(int)
+    {
+        basic_iterator tmp = *this;
+        --offset_;
+        return tmp;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType> &
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator+=(difference_type n)
+    {
+        offset_ += n;
+        return *this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType> &
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator-=(difference_type n)
+    {
+        offset_ -= n;
+        return *this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator+(difference_type n) const
+    {
+        basic_iterator tmp = *this;
+        return tmp += n;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator-(difference_type n) const
+    {
+        basic_iterator tmp = *this;
+        return tmp -= n;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    typename static_circ_buffer<T, N, Index>::template basic_iterator<Container, ValueType>::difference_type
+    static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::operator-(const basic_iterator<Container, ValueType> &it) const
+    {
+        return offset_ - it.offset_;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Container, class ValueType>
+    span<ValueType> static_circ_buffer<T, N, Index>::basic_iterator<Container, ValueType>::segment(const basic_iterator &last) const
+    {
+        if (last.offset_ <= offset_)
+            return span<ValueType>();
+        auto pos = Index::index(circ_->head_ + static_cast<size_type>(offset_), N);
+        auto count = static_cast<size_type>(last.offset_ - offset_);
+        return span<ValueType>(circ_->data() + pos, count < N - pos ? count : N - pos);
+    }
+
+    template <class T, std::size_t N, class Index>
+    static_circ_buffer<T, N, Index>::static_circ_buffer() noexcept
+        : head_(0),
+          tail_(0)
+    {
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Iter, class>
+    static_circ_buffer<T, N, Index>::static_circ_buffer(Iter begin, Iter end)
+        : static_circ_buffer()
+    {
+        push_back(begin, end);
+    }
+
+    template <class T, std::size_t N, class Index>
+    static_circ_buffer<T, N, Index>::static_circ_buffer(const static_circ_buffer &circ)
+        : static_circ_buffer()
+    {
+        push_back(circ.begin(), circ.end());
+    }
+
+    template <class T, std::size_t N, class Index>
+    static_circ_buffer<T, N, Index>::static_circ_buffer(static_circ_buffer &&circ) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : static_circ_buffer()
+    {
+        push_back(std::make_move_iterator(circ.begin()), std::make_move_iterator(circ.end()));
+        circ.clear();
+    }
+
+    template <class T, std::size_t N, class Index>
+    static_circ_buffer<T, N, Index>::~static_circ_buffer()
+    {
+        clear();
+    }
+
+    template <class T, std::size_t N, class Index>
+    static_circ_buffer<T, N, Index> &static_circ_buffer<T, N, Index>::operator=(const static_circ_buffer &circ)
+    {
+        if (this != &circ)
+        {
+            clear();
+            push_back(circ.begin(), circ.end());
+        }
+        return *this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    static_circ_buffer<T, N, Index> &static_circ_buffer<T, N, Index>::operator=(static_circ_buffer &&circ) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+        if (this != &circ)
+        {
+            clear();
+            push_back(std::make_move_iterator(circ.begin()), std::make_move_iterator(circ.end()));
+            circ.clear();
+        }
+        return *this;
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::iterator static_circ_buffer<T, N, Index>::begin() noexcept
+    {
+        return iterator(0, *this);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::iterator static_circ_buffer<T, N, Index>::end() noexcept
+    {
+        return iterator(static_cast<typename iterator::difference_type>(size()), *this);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_iterator static_circ_buffer<T, N, Index>::begin() const noexcept
+    {
+        return cbegin();
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_iterator static_circ_buffer<T, N, Index>::end() const noexcept
+    {
+        return cend();
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_iterator static_circ_buffer<T, N, Index>::cbegin() const noexcept
+    {
+        return const_iterator(0, *this);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_iterator static_circ_buffer<T, N, Index>::cend() const noexcept
+    {
+        return const_iterator(static_cast<typename const_iterator::difference_type>(size()), *this);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::reverse_iterator static_circ_buffer<T, N, Index>::rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::reverse_iterator static_circ_buffer<T, N, Index>::rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_reverse_iterator static_circ_buffer<T, N, Index>::crbegin() const noexcept
+    {
+        return const_reverse_iterator(cend());
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_reverse_iterator static_circ_buffer<T, N, Index>::crend() const noexcept
+    {
+        return const_reverse_iterator(cbegin());
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::push_back(value_type &&a)
+    {
+        emblace_back(std::move(a));
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::push_back(const value_type &a)
+    {
+        emblace_back(a);
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::push_front(value_type &&a)
+    {
+        emblace_front(std::move(a));
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::push_front(const value_type &a)
+    {
+        emblace_front(a);
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::pop_front()
+    {
+        if (size() > 0)
+        {
+            slot(head_)->~T();
+            ++head_;
+        }
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::pop_back()
+    {
+        if (size() > 0)
+        {
+            slot(tail_ - 1)->~T();
+            --tail_;
+        }
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class Iter, class>
+    void static_circ_buffer<T, N, Index>::push_back(Iter first, Iter last)
+    {
+        for (; first != last; ++first)
+            emblace_back(*first);
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::pop_front(size_type count) noexcept
+    {
+        if (count > size())
+            count = size();
+        if (!std::is_trivially_destructible<T>::value)
+            for (size_type i = 0; i < count; ++i)
+                slot(head_ + i)->~T();
+        head_ += count;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class OutIter>
+    OutIter static_circ_buffer<T, N, Index>::copy_out(OutIter dest, size_type count) const
+    {
+        for (auto &segment : readable_segments())
+        {
+            auto n = count < segment.size() ? count : segment.size();
+            dest = std::copy(segment.data(), segment.data() + n, dest);
+            count -= n;
+        }
+        return dest;
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::size_type static_circ_buffer<T, N, Index>::prev_head() noexcept
+    {
+        if (!Index::wraps && head_ == 0)
+        {
+            head_ += N;
+            tail_ += N;
+        }
+        return head_ - 1;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class... Args>
+    typename static_circ_buffer<T, N, Index>::reference static_circ_buffer<T, N, Index>::emblace_front(Args &&...args)
+    {
+        if (size() == N)
+            pop_back();
+        auto new_head = prev_head();
+        auto p = new (slot(new_head)) T(std::forward<Args>(args)...);
+        head_ = new_head;
+        return *p;
+    }
+
+    template <class T, std::size_t N, class Index>
+    template <class... Args>
+    typename static_circ_buffer<T, N, Index>::reference static_circ_buffer<T, N, Index>::emblace_back(Args &&...args)
+    {
+        if (size() == N)
+            pop_front();
+        auto p = new (slot(tail_)) T(std::forward<Args>(args)...);
+        ++tail_;
+        return *p;
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::clear() noexcept
+    {
+        pop_front(size());
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::size_type static_circ_buffer<T, N, Index>::size() const noexcept
+    {
+        return tail_ - head_;
+    }
+
+    template <class T, std::size_t N, class Index>
+    bool static_circ_buffer<T, N, Index>::empty() const noexcept
+    {
+        return tail_ == head_;
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::reference static_circ_buffer<T, N, Index>::front()
+    {
+        if (empty())
+            throw std::underflow_error("static_circ_buffer: tried to access empty container");
+        return *slot(head_);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_reference static_circ_buffer<T, N, Index>::front() const
+    {
+        if (empty())
+            throw std::underflow_error("static_circ_buffer: tried to access empty container");
+        return *slot(head_);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::reference static_circ_buffer<T, N, Index>::back()
+    {
+        if (empty())
+            throw std::underflow_error("static_circ_buffer: tried to access empty container");
+        return *slot(tail_ - 1);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_reference static_circ_buffer<T, N, Index>::back() const
+    {
+        if (empty())
+            throw std::underflow_error("static_circ_buffer: tried to access empty container");
+        return *slot(tail_ - 1);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_reference static_circ_buffer<T, N, Index>::operator[](size_type idx) const noexcept
+    {
+        return *slot(head_ + idx);
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_reference static_circ_buffer<T, N, Index>::at(size_type idx) const
+    {
+        if (idx >= size())
+            throw std::out_of_range("static_circ_buffer: index out of range");
+        return *slot(head_ + idx);
+    }
+
+    template <class T, std::size_t N, class Index>
+    span<T> static_circ_buffer<T, N, Index>::array_one() noexcept
+    {
+        return readable_segments()[0];
+    }
+
+    template <class T, std::size_t N, class Index>
+    span<const T> static_circ_buffer<T, N, Index>::array_one() const noexcept
+    {
+        return readable_segments()[0];
+    }
+
+    template <class T, std::size_t N, class Index>
+    span<T> static_circ_buffer<T, N, Index>::array_two() noexcept
+    {
+        return readable_segments()[1];
+    }
+
+    template <class T, std::size_t N, class Index>
+    span<const T> static_circ_buffer<T, N, Index>::array_two() const noexcept
+    {
+        return readable_segments()[1];
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::segments static_circ_buffer<T, N, Index>::readable_segments() noexcept
+    {
+        auto first = Index::index(head_, N);
+        auto count = size();
+        auto count_one = count < N - first ? count : N - first;
+        return {{span<T>(data() + first, count_one), span<T>(data(), count - count_one)}};
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::const_segments static_circ_buffer<T, N, Index>::readable_segments() const noexcept
+    {
+        auto s = const_cast<static_circ_buffer *>(this)->readable_segments();
+        return {{span<const T>(s[0].data(), s[0].size()), span<const T>(s[1].data(), s[1].size())}};
+    }
+
+    template <class T, std::size_t N, class Index>
+    typename static_circ_buffer<T, N, Index>::segments static_circ_buffer<T, N, Index>::prepare(size_type count) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "static_circ_buffer: prepare requires a trivially copyable type");
+        auto free = N - size();
+        if (count > free)
+            count = free;
+        auto first = Index::index(tail_, N);
+        auto count_one = count < N - first ? count : N - first;
+        return {{span<T>(data() + first, count_one), span<T>(data(), count - count_one)}};
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::commit(size_type count) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "static_circ_buffer: commit requires a trivially copyable type");
+        auto free = N - size();
+        tail_ += count < free ? count : free;
+    }
+
+    template <class T, std::size_t N, class Index>
+    void static_circ_buffer<T, N, Index>::consume(size_type count) noexcept
+    {
+        pop_front(count);
+    }
+} // namespace raphia
+#endif
@@ -0,0 +1,285 @@
+#ifndef RAPHIA_TIMED_CIRC_BUFFER_HPP
+#define RAPHIA_TIMED_CIRC_BUFFER_HPP
+#include "circ_buffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace raphia
+{
+    /** timed_circ_buffer
+     * @brief circular buffer of timestamped elements, for "keep the last few seconds" instead
+     * of "keep the last N". Timestamps never decrease, so the elements are sorted by time and
+     * expire_before() and range() find their bounds with a binary search instead of a scan.
+     * The timestamps live in a ring of their own next to the values, the search only
+     * touches timestamps, which are searched segment by segment on plain pointers.
+     * Like circ_buffer, a push into a full buffer overwrites the oldest element.
+     * @tparam Clock clock the timestamps come from, push_back(a) stamps with Clock::now()
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Clock = std::chrono::steady_clock, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class timed_circ_buffer
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using clock = Clock;
+        using time_point = typename Clock::time_point;
+        using values_type = circ_buffer<T, Alloc, Index>;
+        using times_type = circ_buffer<time_point, typename std::allocator_traits<Alloc>::template rebind_alloc<time_point>, Index>;
+        using const_iterator = typename values_type::const_iterator;
+
+        /** Constructors **/
+
+        /** timed_circ_buffer
+         * @brief constructor
+         * @param count buffer size, rounded according to the index policy
+         */
+        explicit timed_circ_buffer(size_type count, const Alloc &a = Alloc());
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a value stamped with Clock::now() to the end of the buffer
+         * @param a value to be added
+         */
+        void push_back(const value_type &a);
+
+        /** push_back
+         * @brief add a value to the end of the buffer
+         * @param time timestamp of the value, not earlier than the newest timestamp in the buffer
+         * @param a value to be added
+         * @throw invalid_argument if time is earlier than the newest timestamp
+         */
+        void push_back(time_point time, const value_type &a);
+
+        /** pop_front
+         * @brief remove the oldest element
+         */
+        void pop_front();
+
+        /** expire_before
+         * @brief remove all elements stamped before time, in O(log n) plus their destruction
+         * @param time oldest timestamp to keep
+         * @return count of elements removed
+         */
+        size_type expire_before(time_point time) noexcept;
+
+        /** clear
+         * @brief remove all elements
+         */
+        void clear() noexcept;
+
+        /** Lookup **/
+
+        /** lower_bound
+         * @brief position of the first element stamped at or after time, in O(log n)
+         * @return index from the oldest element, size() if there is none
+         */
+        size_type lower_bound(time_point time) const noexcept;
+
+        /** upper_bound
+         * @brief position of the first element stamped after time, in O(log n)
+         * @return index from the oldest element, size() if there is none
+         */
+        size_type upper_bound(time_point time) const noexcept;
+
+        /** range
+         * @brief the elements stamped within [first, last], in O(log n)
+         * @return iterators into values(), subtracting values().begin() gives the index into times()
+         */
+        std::pair<const_iterator, const_iterator> range(time_point first, time_point last) const noexcept;
+
+        /** Element Access **/
+
+        /** values
+         * @brief the values, oldest first
+         */
+        const values_type &values() const noexcept;
+
+        /** times
+         * @brief the timestamps, parallel to values()
+         */
+        const times_type &times() const noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of elements in the buffer
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the buffer is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the buffer capacity
+         */
+        size_type capacity() const noexcept;
+
+    private:
+        /** search
+         * @brief index of the first timestamp at or after from for which before(timestamp)
+         * is false, searched segment by segment
+         * @param gallop probe from, from + 1, from + 3, from + 7... before bisecting, which takes
+         * O(log k) for an answer k elements behind from instead of O(log n)
+         */
+        template <class Before>
+        size_type search(Before before, size_type from, bool gallop) const noexcept;
+
+        values_type values_;
+        times_type times_;
+    };
+
+    template <class T, class Clock, class Alloc, class Index>
+    timed_circ_buffer<T, Clock, Alloc, Index>::timed_circ_buffer(size_type count, const Alloc &a)
+        : values_(count, a),
+          times_(count, typename std::allocator_traits<Alloc>::template rebind_alloc<time_point>(a))
+    {
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    void timed_circ_buffer<T, Clock, Alloc, Index>::push_back(const value_type &a)
+    {
+        auto now = Clock::now();
+        // a clock that isn't steady may step back, keep the order regardless
+        if (!times_.empty() && now < times_.back())
+            now = times_.back();
+        push_back(now, a);
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    void timed_circ_buffer<T, Clock, Alloc, Index>::push_back(time_point time, const value_type &a)
+    {
+        if (!times_.empty() && time < times_.back())
+            throw std::invalid_argument("timed_circ_buffer: timestamps must not decrease");
+        if (values_.capacity() == 0)
+            return;
+        // drop the oldest element from both rings first, so they stay in step if copying a throws
+        if (values_.size() == values_.capacity())
+            pop_front();
+        values_.push_back(a);
+        times_.push_back(time);
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    void timed_circ_buffer<T, Clock, Alloc, Index>::pop_front()
+    {
+        values_.pop_front();
+        times_.pop_front();
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    typename timed_circ_buffer<T, Clock, Alloc, Index>::size_type
+    timed_circ_buffer<T, Clock, Alloc, Index>::expire_before(time_point time) noexcept
+    {
+        auto count = lower_bound(time);
+        values_.pop_front(count);
+        times_.pop_front(count);
+        return count;
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    void timed_circ_buffer<T, Clock, Alloc, Index>::clear() noexcept
+    {
+        values_.clear();
+        times_.clear();
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    template <class Before>
+    typename timed_circ_buffer<T, Clock, Alloc, Index>::size_type
+    timed_circ_buffer<T, Clock, Alloc, Index>::search(Before before, size_type from, bool gallop) const noexcept
+    {
+        auto segments = times_.readable_segments();
+        size_type offset = 0;
+        for (auto &segment : segments)
+        {
+            auto size = segment.size();
+            // the answer is in this segment unless all of it comes before from or before()
+            if (size > 0 && from < offset + size && !before(segment[size - 1]))
+            {
+                auto first = segment.begin() + (from > offset ? from - offset : 0);
+                auto last = segment.end();
+                if (gallop)
+                {
+                    std::size_t step = 1;
+                    while (step < static_cast<std::size_t>(last - first) && before(first[step - 1]))
+                    {
+                        first += step;
+                        step *= 2;
+                    }
+                    if (step < static_cast<std::size_t>(last - first))
+                        last = first + step;
+                }
+                return offset + static_cast<size_type>(std::partition_point(first, last, before) - segment.begin());
+            }
+            offset += size;
+        }
+        return offset;
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    typename timed_circ_buffer<T, Clock, Alloc, Index>::size_type
+    timed_circ_buffer<T, Clock, Alloc, Index>::lower_bound(time_point time) const noexcept
+    {
+        return search([time](const time_point &t) { return t < time; }, 0, false);
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    typename timed_circ_buffer<T, Clock, Alloc, Index>::size_type
+    timed_circ_buffer<T, Clock, Alloc, Index>::upper_bound(time_point time) const noexcept
+    {
+        return search([time](const time_point &t) { return !(time < t); }, 0, false);
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    std::pair<typename timed_circ_buffer<T, Clock, Alloc, Index>::const_iterator,
+              typename timed_circ_buffer<T, Clock, Alloc, Index>::const_iterator>
+    timed_circ_buffer<T, Clock, Alloc, Index>::range(time_point first, time_point last) const noexcept
+    {
+        auto begin = lower_bound(first);
+        // windows are usually short, so the end is found faster by galloping from the beginning
+        auto end = last < first ? begin : search([last](const time_point &t) { return !(last < t); }, begin, true);
+        using difference_type = typename const_iterator::difference_type;
+        return std::make_pair(values_.cbegin() + static_cast<difference_type>(begin),
+                              values_.cbegin() + static_cast<difference_type>(end));
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    const typename timed_circ_buffer<T, Clock, Alloc, Index>::values_type &
+    timed_circ_buffer<T, Clock, Alloc, Index>::values() const noexcept
+    {
+        return values_;
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    const typename timed_circ_buffer<T, Clock, Alloc, Index>::times_type &
+    timed_circ_buffer<T, Clock, Alloc, Index>::times() const noexcept
+    {
+        return times_;
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    typename timed_circ_buffer<T, Clock, Alloc, Index>::size_type
+    timed_circ_buffer<T, Clock, Alloc, Index>::size() const noexcept
+    {
+        return values_.size();
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    bool timed_circ_buffer<T, Clock, Alloc, Index>::empty() const noexcept
+    {
+        return values_.empty();
+    }
+
+    template <class T, class Clock, class Alloc, class Index>
+    typename timed_circ_buffer<T, Clock, Alloc, Index>::size_type
+    timed_circ_buffer<T, Clock, Alloc, Index>::capacity() const noexcept
+    {
+        return values_.capacity();
+    }
+} // namespace raphia
+#endif
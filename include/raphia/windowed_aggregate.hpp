@@ -0,0 +1,290 @@
+#ifndef RAPHIA_WINDOWED_AGGREGATE_HPP
+#define RAPHIA_WINDOWED_AGGREGATE_HPP
+#include "circ_buffer.hpp"
+#include <functional>
+
+namespace raphia
+{
+    /** windowed_aggregate
+     * @brief fixed length window over the last values pushed, keeps sum, mean, variance,
+     * min and max up to date as values enter and leave, so every query is O(1).
+     * Min and max are tracked with monotonic queues of window positions,
+     * the running mean and variance with Welford's method (and its inverse on removal).
+     * @tparam Compare ordering used for min() and max()
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Compare = std::less<T>, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class windowed_aggregate
+    {
+    public:
+        using value_type = T;
+        using const_reference = const value_type &;
+        using size_type = std::size_t;
+        using window_type = circ_buffer<T, Alloc, Index>;
+
+        /** Constructors **/
+
+        /** windowed_aggregate
+         * @brief constructor
+         * @param count window length, rounded according to the index policy
+         */
+        explicit windowed_aggregate(size_type count, const Compare &comp = Compare(), const Alloc &a = Alloc());
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a value to the window, if the window is full,
+         * the oldest value leaves it
+         * @param a value to be added
+         */
+        void push_back(const value_type &a);
+
+        /** pop_front
+         * @brief remove the oldest value from the window
+         */
+        void pop_front();
+
+        /** clear
+         * @brief empty the window and reset the aggregates
+         */
+        void clear() noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of values in the window
+         * @return current count of values in the window
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the window is empty
+         * @return true if window is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the window length
+         * @return window length
+         */
+        size_type capacity() const noexcept;
+
+        /** Aggregates **/
+
+        /** sum
+         * @brief sum of the values in the window, floating point sums
+         * may drift a little from the exact sum after many updates
+         * @return sum, T() if the window is empty
+         */
+        value_type sum() const noexcept;
+
+        /** mean
+         * @brief arithmetic mean of the values in the window
+         * @return mean, 0 if the window is empty
+         */
+        double mean() const noexcept;
+
+        /** variance
+         * @brief population variance of the values in the window
+         * @return variance, 0 if the window holds less than two values
+         */
+        double variance() const noexcept;
+
+        /** min
+         * @brief smallest value in the window according to Compare
+         * @throw underflow_error if the window is empty
+         */
+        const_reference min() const;
+
+        /** max
+         * @brief largest value in the window according to Compare
+         * @throw underflow_error if the window is empty
+         */
+        const_reference max() const;
+
+        /** window
+         * @brief the values in the window, oldest first
+         */
+        const window_type &window() const noexcept;
+
+    private:
+        /** value_at
+         * @brief value at the absolute position pos, it must still be in the window
+         */
+        const_reference value_at(size_type pos) const noexcept;
+
+        /** remove
+         * @brief update the aggregates for the oldest value that is about to leave the window
+         */
+        void remove() noexcept;
+
+        window_type window_;
+        // absolute positions of candidates for min() and max(), their values are
+        // ascending (resp. descending) according to Compare, so the front is the answer
+        circ_buffer<size_type> min_queue_;
+        circ_buffer<size_type> max_queue_;
+        Compare comp_;
+        // absolute position of the oldest value in the window
+        size_type first_;
+        value_type sum_;
+        double mean_;
+        double m2_;
+    };
+
+    template <class T, class Compare, class Alloc, class Index>
+    windowed_aggregate<T, Compare, Alloc, Index>::windowed_aggregate(size_type count, const Compare &comp, const Alloc &a)
+        : window_(count, a),
+          min_queue_(window_.capacity()),
+          max_queue_(window_.capacity()),
+          comp_(comp),
+          first_(0),
+          sum_(),
+          mean_(0),
+          m2_(0)
+    {
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    void windowed_aggregate<T, Compare, Alloc, Index>::push_back(const value_type &a)
+    {
+        if (window_.capacity() == 0)
+            return;
+        if (window_.size() == window_.capacity())
+            pop_front();
+        auto pos = first_ + window_.size();
+        window_.push_back(a);
+        // values that are older and not smaller (not larger) can never become the answer
+        while (!min_queue_.empty() && !comp_(value_at(min_queue_.back()), a))
+            min_queue_.pop_back();
+        min_queue_.push_back(pos);
+        while (!max_queue_.empty() && !comp_(a, value_at(max_queue_.back())))
+            max_queue_.pop_back();
+        max_queue_.push_back(pos);
+
+        sum_ += a;
+        auto n = static_cast<double>(window_.size());
+        auto x = static_cast<double>(a);
+        auto delta = x - mean_;
+        mean_ += delta / n;
+        m2_ += delta * (x - mean_);
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    void windowed_aggregate<T, Compare, Alloc, Index>::pop_front()
+    {
+        if (window_.empty())
+            return;
+        remove();
+        window_.pop_front();
+        ++first_;
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    void windowed_aggregate<T, Compare, Alloc, Index>::remove() noexcept
+    {
+        const auto &a = window_.front();
+        if (min_queue_.front() == first_)
+            min_queue_.pop_front();
+        if (max_queue_.front() == first_)
+            max_queue_.pop_front();
+
+        sum_ -= a;
+        auto n = static_cast<double>(window_.size() - 1);
+        if (n == 0)
+        {
+            mean_ = 0;
+            m2_ = 0;
+            return;
+        }
+        auto x = static_cast<double>(a);
+        auto delta = x - mean_;
+        mean_ -= delta / n;
+        m2_ -= delta * (x - mean_);
+        if (m2_ < 0)
+            m2_ = 0; // rounding
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    void windowed_aggregate<T, Compare, Alloc, Index>::clear() noexcept
+    {
+        first_ += window_.size();
+        window_.clear();
+        min_queue_.clear();
+        max_queue_.clear();
+        sum_ = value_type();
+        mean_ = 0;
+        m2_ = 0;
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    typename windowed_aggregate<T, Compare, Alloc, Index>::size_type
+    windowed_aggregate<T, Compare, Alloc, Index>::size() const noexcept
+    {
+        return window_.size();
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    bool windowed_aggregate<T, Compare, Alloc, Index>::empty() const noexcept
+    {
+        return window_.empty();
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    typename windowed_aggregate<T, Compare, Alloc, Index>::size_type
+    windowed_aggregate<T, Compare, Alloc, Index>::capacity() const noexcept
+    {
+        return window_.capacity();
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    typename windowed_aggregate<T, Compare, Alloc, Index>::value_type
+    windowed_aggregate<T, Compare, Alloc, Index>::sum() const noexcept
+    {
+        return sum_;
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    double windowed_aggregate<T, Compare, Alloc, Index>::mean() const noexcept
+    {
+        return mean_;
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    double windowed_aggregate<T, Compare, Alloc, Index>::variance() const noexcept
+    {
+        return window_.size() < 2 ? 0 : m2_ / static_cast<double>(window_.size());
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    typename windowed_aggregate<T, Compare, Alloc, Index>::const_reference
+    windowed_aggregate<T, Compare, Alloc, Index>::min() const
+    {
+        if (empty())
+            throw std::underflow_error("windowed_aggregate: tried to access empty window");
+        return value_at(min_queue_.front());
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    typename windowed_aggregate<T, Compare, Alloc, Index>::const_reference
+    windowed_aggregate<T, Compare, Alloc, Index>::max() const
+    {
+        if (empty())
+            throw std::underflow_error("windowed_aggregate: tried to access empty window");
+        return value_at(max_queue_.front());
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    const typename windowed_aggregate<T, Compare, Alloc, Index>::window_type &
+    windowed_aggregate<T, Compare, Alloc, Index>::window() const noexcept
+    {
+        return window_;
+    }
+
+    template <class T, class Compare, class Alloc, class Index>
+    typename windowed_aggregate<T, Compare, Alloc, Index>::const_reference
+    windowed_aggregate<T, Compare, Alloc, Index>::value_at(size_type pos) const noexcept
+    {
+        return window_[static_cast<int>(pos - first_)];
+    }
+} // namespace raphia
+#endif
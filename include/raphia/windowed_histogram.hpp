@@ -0,0 +1,320 @@
+#ifndef RAPHIA_WINDOWED_HISTOGRAM_HPP
+#define RAPHIA_WINDOWED_HISTOGRAM_HPP
+#include "circ_buffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace raphia
+{
+    /** log_histogram
+     * @brief histogram with logarithmic buckets in the style of HdrHistogram, every power of two
+     * is split into 2^precision_bits buckets, so a bucket spans at most 2^-precision_bits
+     * of its values. Values can be added and removed, the memory is fixed at construction.
+     */
+    class log_histogram
+    {
+    public:
+        using size_type = std::size_t;
+
+        /** log_histogram
+         * @brief constructor
+         * @param lowest smallest value to be told apart, smaller values land in the first bucket
+         * @param highest largest value to be told apart, larger values land in the last bucket
+         * @param precision_bits log2 of the buckets per power of two
+         * @throw invalid_argument if lowest isn't positive, highest is below lowest
+         * or precision_bits is above 16
+         */
+        log_histogram(double lowest, double highest, unsigned precision_bits = 7);
+
+        /** add
+         * @brief count a value
+         */
+        void add(double value) noexcept;
+
+        /** remove
+         * @brief remove a value that has been added before
+         */
+        void remove(double value) noexcept;
+
+        /** clear
+         * @brief remove all values
+         */
+        void clear() noexcept;
+
+        /** count
+         * @brief number of values in the histogram
+         */
+        size_type count() const noexcept;
+
+        /** quantile
+         * @brief approximate value below which the fraction q of the values lie,
+         * takes a pass over the buckets but never looks at the values themselves
+         * @param q quantile between 0 and 1, e.g. 0.99
+         * @return midpoint of the bucket holding the quantile, 0 if the histogram is empty
+         */
+        double quantile(double q) const noexcept;
+
+        /** bucket_count
+         * @brief number of buckets, which is the memory footprint in counters
+         */
+        size_type bucket_count() const noexcept;
+
+    private:
+        /** bucket
+         * @brief index of the bucket counting value
+         */
+        size_type bucket(double value) const noexcept;
+
+        /** midpoint
+         * @brief value that represents the bucket at index
+         */
+        double midpoint(size_type index) const noexcept;
+
+        std::vector<size_type> counts_;
+        size_type count_;
+        int min_exponent_;
+        int max_exponent_;
+        unsigned precision_bits_;
+    };
+
+    inline log_histogram::log_histogram(double lowest, double highest, unsigned precision_bits)
+        : count_(0),
+          min_exponent_(0),
+          max_exponent_(0),
+          precision_bits_(precision_bits)
+    {
+        if (!(lowest > 0) || highest < lowest || precision_bits > 16)
+            throw std::invalid_argument("log_histogram: invalid range or precision");
+        std::frexp(lowest, &min_exponent_);
+        std::frexp(highest, &max_exponent_);
+        counts_.resize(static_cast<size_type>(max_exponent_ - min_exponent_ + 1) << precision_bits_);
+    }
+
+    inline void log_histogram::add(double value) noexcept
+    {
+        ++counts_[bucket(value)];
+        ++count_;
+    }
+
+    inline void log_histogram::remove(double value) noexcept
+    {
+        --counts_[bucket(value)];
+        --count_;
+    }
+
+    inline void log_histogram::clear() noexcept
+    {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        count_ = 0;
+    }
+
+    inline log_histogram::size_type log_histogram::count() const noexcept
+    {
+        return count_;
+    }
+
+    inline log_histogram::size_type log_histogram::bucket_count() const noexcept
+    {
+        return counts_.size();
+    }
+
+    inline double log_histogram::quantile(double q) const noexcept
+    {
+        if (count_ == 0)
+            return 0;
+        q = q < 0 ? 0 : (q > 1 ? 1 : q);
+        // the rank of the value we are looking for, counting from 1
+        auto rank = static_cast<size_type>(std::ceil(q * static_cast<double>(count_)));
+        if (rank == 0)
+            rank = 1;
+        size_type seen = 0;
+        for (size_type i = 0; i < counts_.size(); ++i)
+        {
+            seen += counts_[i];
+            if (seen >= rank)
+                return midpoint(i);
+        }
+        return midpoint(counts_.size() - 1);
+    }
+
+    inline log_histogram::size_type log_histogram::bucket(double value) const noexcept
+    {
+        if (!(value > 0)) // includes NaN
+            return 0;
+        int exponent;
+        auto mantissa = std::frexp(value, &exponent); // value = mantissa * 2^exponent, mantissa in [0.5, 1)
+        if (exponent < min_exponent_)
+            return 0;
+        if (exponent > max_exponent_)
+            return counts_.size() - 1;
+        auto sub = static_cast<size_type>((mantissa - 0.5) * static_cast<double>(size_type(2) << precision_bits_));
+        return (static_cast<size_type>(exponent - min_exponent_) << precision_bits_) + sub;
+    }
+
+    inline double log_histogram::midpoint(size_type index) const noexcept
+    {
+        auto exponent = min_exponent_ + static_cast<int>(index >> precision_bits_);
+        auto sub = static_cast<double>(index & ((size_type(1) << precision_bits_) - 1));
+        auto mantissa = 0.5 + (sub + 0.5) / static_cast<double>(size_type(2) << precision_bits_);
+        return std::ldexp(mantissa, exponent);
+    }
+
+    /** windowed_histogram
+     * @brief fixed length window over the last values pushed, with a log_histogram that
+     * always counts exactly the values in the window. Quantiles are answered from the
+     * histogram, the window is never copied or sorted.
+     * @tparam Index policy mapping the free running counters onto buffer slots
+     */
+    template <class T, class Alloc = std::allocator<T>, class Index = modulo_index>
+    class windowed_histogram
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using window_type = circ_buffer<T, Alloc, Index>;
+
+        /** Constructors **/
+
+        /** windowed_histogram
+         * @brief constructor
+         * @param count window length, rounded according to the index policy
+         * @param lowest, highest, precision_bits see log_histogram
+         */
+        windowed_histogram(size_type count, double lowest, double highest, unsigned precision_bits = 7, const Alloc &a = Alloc());
+
+        /** Modifiers **/
+
+        /** push_back
+         * @brief add a value to the window, if the window is full,
+         * the oldest value leaves it and the histogram
+         * @param a value to be added
+         */
+        void push_back(const value_type &a);
+
+        /** pop_front
+         * @brief remove the oldest value from the window
+         */
+        void pop_front();
+
+        /** clear
+         * @brief empty the window and the histogram
+         */
+        void clear() noexcept;
+
+        /** Capacity Methods **/
+
+        /** size
+         * @brief return the current count of values in the window
+         * @return current count of values in the window
+         */
+        size_type size() const noexcept;
+
+        /** empty
+         * @brief check whether the window is empty
+         * @return true if window is empty
+         */
+        bool empty() const noexcept;
+
+        /** capacity
+         * @brief get the window length
+         * @return window length
+         */
+        size_type capacity() const noexcept;
+
+        /** Queries **/
+
+        /** quantile
+         * @brief approximate quantile of the values in the window, see log_histogram::quantile
+         */
+        double quantile(double q) const noexcept;
+
+        /** histogram
+         * @brief the histogram of the values in the window
+         */
+        const log_histogram &histogram() const noexcept;
+
+        /** window
+         * @brief the values in the window, oldest first
+         */
+        const window_type &window() const noexcept;
+
+    private:
+        window_type window_;
+        log_histogram histogram_;
+    };
+
+    template <class T, class Alloc, class Index>
+    windowed_histogram<T, Alloc, Index>::windowed_histogram(size_type count, double lowest, double highest, unsigned precision_bits, const Alloc &a)
+        : window_(count, a),
+          histogram_(lowest, highest, precision_bits)
+    {
+    }
+
+    template <class T, class Alloc, class Index>
+    void windowed_histogram<T, Alloc, Index>::push_back(const value_type &a)
+    {
+        if (window_.capacity() == 0)
+            return;
+        if (window_.size() == window_.capacity())
+            pop_front();
+        window_.push_back(a);
+        histogram_.add(static_cast<double>(a));
+    }
+
+    template <class T, class Alloc, class Index>
+    void windowed_histogram<T, Alloc, Index>::pop_front()
+    {
+        if (window_.empty())
+            return;
+        histogram_.remove(static_cast<double>(window_.front()));
+        window_.pop_front();
+    }
+
+    template <class T, class Alloc, class Index>
+    void windowed_histogram<T, Alloc, Index>::clear() noexcept
+    {
+        window_.clear();
+        histogram_.clear();
+    }
+
+    template <class T, class Alloc, class Index>
+    typename windowed_histogram<T, Alloc, Index>::size_type
+    windowed_histogram<T, Alloc, Index>::size() const noexcept
+    {
+        return window_.size();
+    }
+
+    template <class T, class Alloc, class Index>
+    bool windowed_histogram<T, Alloc, Index>::empty() const noexcept
+    {
+        return window_.empty();
+    }
+
+    template <class T, class Alloc, class Index>
+    typename windowed_histogram<T, Alloc, Index>::size_type
+    windowed_histogram<T, Alloc, Index>::capacity() const noexcept
+    {
+        return window_.capacity();
+    }
+
+    template <class T, class Alloc, class Index>
+    double windowed_histogram<T, Alloc, Index>::quantile(double q) const noexcept
+    {
+        return histogram_.quantile(q);
+    }
+
+    template <class T, class Alloc, class Index>
+    const log_histogram &windowed_histogram<T, Alloc, Index>::histogram() const noexcept
+    {
+        return histogram_;
+    }
+
+    template <class T, class Alloc, class Index>
+    const typename windowed_histogram<T, Alloc, Index>::window_type &
+    windowed_histogram<T, Alloc, Index>::window() const noexcept
+    {
+        return window_;
+    }
+} // namespace raphia
+#endif
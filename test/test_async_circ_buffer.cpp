@@ -0,0 +1,158 @@
+#include "raphia/async_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using ring = raphia::async_circ_buffer<int>;
+
+    raphia::task produce(ring &circ, int first, int count, std::vector<bool> &results)
+    {
+        for (int i = first; i < first + count; ++i)
+            results.push_back(co_await circ.async_push(i));
+    }
+
+    raphia::task consume(ring &circ, std::vector<int> &values, bool &finished)
+    {
+        while (auto value = co_await circ.async_pop())
+            values.push_back(*value);
+        finished = true;
+    }
+
+    raphia::task consume_one(ring &circ, std::vector<int> &values)
+    {
+        if (auto value = co_await circ.async_pop())
+            values.push_back(*value);
+    }
+} // namespace
+
+TEST_CASE("async_circ_buffer::async_circ_buffer(size_type)", "[async][ctor]")
+{
+    raphia::single_thread_executor executor;
+    ring circ(3, executor);
+    CHECK(circ.capacity() == 3);
+    CHECK(circ.empty());
+    CHECK_THROWS_AS(ring(0, executor), std::invalid_argument);
+}
+
+TEST_CASE("async_circ_buffer producer and consumer", "[async]")
+{
+    raphia::single_thread_executor executor;
+    ring circ(2, executor);
+    std::vector<bool> pushed;
+    std::vector<int> values;
+    bool finished = false;
+    SECTION("the producer suspends while the buffer is full")
+    {
+        executor.spawn(produce(circ, 0, 5, pushed));
+        executor.run();
+        CHECK(circ.size() == 2);
+        CHECK(pushed.size() == 2);
+        executor.spawn(consume(circ, values, finished));
+        executor.run();
+        CHECK(values == std::vector<int>({0, 1, 2, 3, 4}));
+        CHECK(pushed == std::vector<bool>(5, true));
+        CHECK(circ.empty());
+        CHECK(!finished);
+        circ.close();
+        executor.run();
+        CHECK(finished);
+    }
+    SECTION("the consumer suspends while the buffer is empty")
+    {
+        executor.spawn(consume(circ, values, finished));
+        executor.run();
+        CHECK(values.empty());
+        executor.spawn(produce(circ, 0, 5, pushed));
+        executor.run();
+        CHECK(values == std::vector<int>({0, 1, 2, 3, 4}));
+        CHECK(circ.empty());
+        circ.close();
+        executor.run();
+        CHECK(finished);
+    }
+    SECTION("waiters are served in order")
+    {
+        executor.spawn(consume_one(circ, values));
+        executor.spawn(consume_one(circ, values));
+        executor.run();
+        executor.spawn(produce(circ, 0, 2, pushed));
+        executor.spawn(produce(circ, 10, 3, pushed));
+        executor.run();
+        CHECK(values == std::vector<int>({0, 1}));
+        CHECK(circ.size() == 2);
+        executor.spawn(consume(circ, values, finished));
+        executor.run();
+        CHECK(values == std::vector<int>({0, 1, 10, 11, 12}));
+        circ.close();
+        executor.run();
+        CHECK(pushed == std::vector<bool>(5, true));
+        CHECK(finished);
+    }
+    SECTION("close wakes suspended producers")
+    {
+        executor.spawn(produce(circ, 0, 4, pushed));
+        executor.run();
+        circ.close();
+        executor.run();
+        CHECK(pushed == std::vector<bool>({true, true, false, false}));
+        executor.spawn(consume(circ, values, finished));
+        executor.run();
+        CHECK(values == std::vector<int>({0, 1}));
+        CHECK(finished);
+    }
+}
+
+TEST_CASE("async_circ_buffer moves the values", "[async]")
+{
+    raphia::single_thread_executor executor;
+    raphia::async_circ_buffer<std::unique_ptr<std::string>> circ(1, executor);
+    std::string result;
+    auto producer = [&circ]() -> raphia::task {
+        for (auto s : {"a", "b", "c"})
+            co_await circ.async_push(std::make_unique<std::string>(s));
+        circ.close();
+    };
+    auto consumer = [&circ, &result]() -> raphia::task {
+        while (auto value = co_await circ.async_pop())
+            result += **value;
+    };
+    executor.spawn(producer());
+    executor.spawn(consumer());
+    executor.run();
+    CHECK(result == "abc");
+}
+
+TEST_CASE("async_circ_buffer with many tasks", "[async]")
+{
+    raphia::single_thread_executor executor;
+    ring circ(4, executor);
+    std::vector<bool> pushed;
+    std::vector<int> values;
+    std::vector<std::unique_ptr<bool>> finished;
+    for (int i = 0; i < 100; ++i)
+        executor.spawn(produce(circ, i * 100, 100, pushed));
+    for (int i = 0; i < 10; ++i)
+    {
+        finished.push_back(std::make_unique<bool>(false));
+        executor.spawn(consume(circ, values, *finished.back()));
+    }
+    executor.run();
+    circ.close();
+    executor.run();
+    CHECK(values.size() == 10000);
+    CHECK(pushed == std::vector<bool>(10000, true));
+    bool all = true;
+    for (auto &f : finished)
+        all = all && *f;
+    CHECK(all);
+    // with several consumers values may be recorded out of order, but each arrives once
+    std::sort(values.begin(), values.end());
+    bool complete = true;
+    for (std::size_t i = 0; i < values.size(); ++i)
+        complete = complete && values[i] == static_cast<int>(i);
+    CHECK(complete);
+}
@@ -0,0 +1,147 @@
+#include "raphia/blocking_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("blocking_circ_buffer::blocking_circ_buffer(size_type)", "[blocking][ctor]")
+{
+    raphia::blocking_circ_buffer<int> circ(8);
+    CHECK(circ.capacity() == 8);
+    CHECK(circ.empty());
+    CHECK(!circ.closed());
+    CHECK_THROWS_AS(raphia::blocking_circ_buffer<int>(0), std::invalid_argument);
+}
+
+TEST_CASE("blocking_circ_buffer::pop_bulk()", "[blocking][modifier]")
+{
+    raphia::blocking_circ_buffer<std::string> circ(4);
+    std::vector<std::string> out;
+    SECTION("takes at most max elements, oldest first")
+    {
+        CHECK(circ.push("a"));
+        CHECK(circ.push(std::string("b")));
+        CHECK(circ.emplace(2, 'c'));
+        CHECK(circ.size() == 3);
+        CHECK(circ.pop_bulk(std::back_inserter(out), 2) == 2);
+        CHECK(out == std::vector<std::string>{"a", "b"});
+        CHECK(circ.pop_bulk(std::back_inserter(out), 2, std::chrono::milliseconds(0)) == 1);
+        CHECK(out.back() == "cc");
+        CHECK(circ.empty());
+    }
+    SECTION("try_push fails on a full buffer")
+    {
+        for (int i = 0; i < 4; ++i)
+            CHECK(circ.try_push("x"));
+        CHECK(!circ.try_push("y"));
+    }
+    SECTION("times out on an empty buffer")
+    {
+        auto start = std::chrono::steady_clock::now();
+        CHECK(circ.pop_bulk(std::back_inserter(out), 4, std::chrono::milliseconds(20)) == 0);
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    }
+    SECTION("close rejects pushes but leaves the elements to the consumers")
+    {
+        circ.push("a");
+        circ.close();
+        CHECK(circ.closed());
+        CHECK(!circ.push("b"));
+        CHECK(!circ.try_push("b"));
+        CHECK(circ.pop_bulk(std::back_inserter(out), 4) == 1);
+        CHECK(circ.pop_bulk(std::back_inserter(out), 4) == 0);
+    }
+}
+
+TEST_CASE("blocking_circ_buffer wakes parked threads", "[blocking]")
+{
+    raphia::blocking_circ_buffer<int> circ(4);
+    SECTION("a parked consumer gets the element")
+    {
+        std::vector<int> out;
+        std::thread consumer([&] { circ.pop_bulk(std::back_inserter(out), 4); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        circ.push(42);
+        consumer.join();
+        CHECK(out == std::vector<int>{42});
+    }
+    SECTION("close wakes a parked consumer")
+    {
+        std::vector<int> out;
+        std::size_t count = 1;
+        std::thread consumer([&] { count = circ.pop_bulk(std::back_inserter(out), 4); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        circ.close();
+        consumer.join();
+        CHECK(count == 0);
+    }
+    SECTION("a parked producer continues once there is room")
+    {
+        for (int i = 0; i < 4; ++i)
+            circ.push(i);
+        std::thread producer([&] { circ.push(4); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<int> out;
+        circ.pop_bulk(std::back_inserter(out), 2);
+        producer.join();
+        circ.pop_bulk(std::back_inserter(out), 4);
+        CHECK(out == std::vector<int>{0, 1, 2, 3, 4});
+    }
+    SECTION("a consumer that times out doesn't swallow the next wakeup")
+    {
+        std::vector<int> out;
+        CHECK(circ.pop_bulk(std::back_inserter(out), 4, std::chrono::milliseconds(5)) == 0);
+        std::thread consumer([&] { circ.pop_bulk(std::back_inserter(out), 4); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        circ.push(1);
+        consumer.join();
+        std::thread second([&] { circ.pop_bulk(std::back_inserter(out), 4); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        circ.push(2);
+        second.join();
+        CHECK(out == std::vector<int>{1, 2});
+    }
+}
+
+TEST_CASE("blocking_circ_buffer with several producers and consumers", "[blocking]")
+{
+    const int producers = 3;
+    const int per_producer = 20000;
+    raphia::blocking_circ_buffer<int> circ(64);
+    std::vector<std::vector<int>> received(3);
+    std::vector<std::thread> threads;
+    for (auto &r : received)
+        threads.emplace_back([&circ, &r] {
+            while (circ.pop_bulk(std::back_inserter(r), 16) > 0)
+            {
+            }
+        });
+    std::vector<std::thread> producer_threads;
+    for (int p = 0; p < producers; ++p)
+        producer_threads.emplace_back([&circ, p] {
+            for (int i = 0; i < per_producer; ++i)
+                circ.push(p * per_producer + i);
+        });
+    for (auto &t : producer_threads)
+        t.join();
+    circ.close();
+    for (auto &t : threads)
+        t.join();
+    std::vector<int> seen(producers * per_producer, 0);
+    bool ordered = true;
+    for (auto &r : received)
+    {
+        std::vector<int> last(producers, -1);
+        for (auto v : r)
+        {
+            ++seen[static_cast<std::size_t>(v)];
+            // the elements of one producer reach each consumer in order
+            ordered = ordered && v > last[static_cast<std::size_t>(v / per_producer)];
+            last[static_cast<std::size_t>(v / per_producer)] = v;
+        }
+    }
+    CHECK(ordered);
+    CHECK(std::count(seen.begin(), seen.end(), 1) == producers * per_producer);
+}
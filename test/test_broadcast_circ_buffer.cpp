@@ -0,0 +1,120 @@
+#include "raphia/broadcast_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct event
+    {
+        std::uint64_t sequence;
+        std::uint64_t check;
+    };
+} // namespace
+
+TEST_CASE("broadcast_circ_buffer::broadcast_circ_buffer(size_type)", "[broadcast][ctor]")
+{
+    raphia::broadcast_circ_buffer<int, std::allocator<int>, raphia::pow2_index> circ(5);
+    CHECK(circ.capacity() == 8);
+    CHECK(circ.published() == 0);
+    CHECK_THROWS_AS((raphia::broadcast_circ_buffer<int>(0)), std::invalid_argument);
+}
+
+TEST_CASE("broadcast_circ_buffer readers", "[broadcast][modifier]")
+{
+    raphia::broadcast_circ_buffer<int> circ(4);
+    circ.push(-1);
+    raphia::broadcast_circ_buffer<int>::reader first(circ);
+    int a = 0;
+    SECTION("a reader starts behind the elements pushed so far")
+    {
+        CHECK(first.available() == 0);
+        CHECK(!first.try_pop(a));
+    }
+    SECTION("every reader sees every element")
+    {
+        raphia::broadcast_circ_buffer<int>::reader second(circ);
+        for (int i = 0; i < 3; ++i)
+            circ.push(i);
+        CHECK(first.available() == 3);
+        for (int i = 0; i < 3; ++i)
+        {
+            REQUIRE(first.try_pop(a));
+            CHECK(a == i);
+        }
+        CHECK(!first.try_pop(a));
+        CHECK(second.available() == 3);
+        REQUIRE(second.try_pop(a));
+        CHECK(a == 0);
+        CHECK(first.lost() == 0);
+        CHECK(second.lost() == 0);
+    }
+    SECTION("a lapped reader skips to the oldest element and counts the lost ones")
+    {
+        for (int i = 0; i < 10; ++i)
+            circ.push(i);
+        CHECK(first.available() == 10);
+        REQUIRE(first.try_pop(a));
+        CHECK(a == 6);
+        CHECK(first.lost() == 6);
+        for (int i = 7; i < 10; ++i)
+        {
+            REQUIRE(first.try_pop(a));
+            CHECK(a == i);
+        }
+        CHECK(!first.try_pop(a));
+        CHECK(first.lost() == 6);
+    }
+}
+
+TEST_CASE("broadcast_circ_buffer with concurrent readers", "[broadcast]")
+{
+    const std::uint64_t count = 200000;
+    raphia::broadcast_circ_buffer<event> circ(64);
+    std::vector<raphia::broadcast_circ_buffer<event>::reader> readers(3, raphia::broadcast_circ_buffer<event>::reader(circ));
+    std::vector<bool> consistent(readers.size(), true);
+    std::vector<std::uint64_t> received(readers.size(), 0);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+    for (std::size_t r = 0; r < readers.size(); ++r)
+    {
+        threads.emplace_back([&, r] {
+            auto &reader = readers[r];
+            std::uint64_t expected = 0;
+            event e;
+            for (;;)
+            {
+                auto finished = done.load();
+                auto lost = reader.lost();
+                while (reader.try_pop(e))
+                {
+                    // the sequence tells exactly how many elements were skipped
+                    expected += reader.lost() - lost;
+                    lost = reader.lost();
+                    if (e.sequence != expected || e.check != ~expected)
+                        consistent[r] = false;
+                    ++expected;
+                    ++received[r];
+                }
+                if (finished)
+                    break;
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        circ.push({i, ~i});
+        if (i % 16 == 0)
+            std::this_thread::yield();
+    }
+    done = true;
+    for (auto &t : threads)
+        t.join();
+    for (std::size_t r = 0; r < readers.size(); ++r)
+    {
+        CHECK(consistent[r]);
+        CHECK(received[r] + readers[r].lost() == count);
+    }
+}
@@ -0,0 +1,102 @@
+#include "raphia/circ_algorithm.hpp"
+#include "raphia/static_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+    // fills the buffer so the elements wrap around in the middle of the storage
+    template <class Circ, class Gen>
+    void fill_wrapped(Circ &circ, std::size_t count, Gen gen)
+    {
+        for (std::size_t i = 0; i < circ.capacity() / 2 + 3; ++i)
+            circ.push_back(gen());
+        circ.pop_front(circ.size());
+        for (std::size_t i = 0; i < count; ++i)
+            circ.push_back(gen());
+    }
+} // namespace
+
+TEST_CASE("raphia::find() and raphia::count() on bytes", "[algorithm]")
+{
+    // sizes around the vector widths, so the scalar tails are covered as well
+    for (std::size_t size : {0, 1, 15, 16, 17, 31, 33, 100, 1000})
+    {
+        raphia::circ_buffer<char> circ(1000);
+        std::uint32_t seed = static_cast<std::uint32_t>(size);
+        fill_wrapped(circ, size, [&seed]
+                     { return static_cast<char>('a' + (seed = seed * 1664525u + 1013904223u) % 20); });
+        for (char c : {'a', 'j', 't', '\n'})
+        {
+            REQUIRE(raphia::find(circ, c) == std::find(circ.cbegin(), circ.cend(), c));
+            REQUIRE(raphia::count(circ, c) == static_cast<std::size_t>(std::count(circ.begin(), circ.end(), c)));
+        }
+    }
+}
+
+TEST_CASE("raphia::find() with a start position", "[algorithm]")
+{
+    raphia::circ_buffer<char> circ(64);
+    std::string lines = "first line\nsecond line\nthird";
+    fill_wrapped(circ, 0, []
+                 { return 'x'; });
+    circ.push_back(lines.begin(), lines.end());
+    auto it = raphia::find(circ, '\n');
+    REQUIRE(it - circ.cbegin() == 10);
+    it = raphia::find(circ, '\n', static_cast<std::size_t>(it - circ.cbegin()) + 1);
+    REQUIRE(it - circ.cbegin() == 22);
+    it = raphia::find(circ, '\n', static_cast<std::size_t>(it - circ.cbegin()) + 1);
+    CHECK(it == circ.cend());
+    CHECK(raphia::find(circ, 'f', 100) == circ.cend());
+}
+
+TEST_CASE("raphia::sum() and raphia::min_max()", "[algorithm]")
+{
+    SECTION("bytes")
+    {
+        for (std::size_t size : {1, 15, 16, 17, 33, 1000, 4096})
+        {
+            raphia::circ_buffer<std::uint8_t> circ(4096);
+            std::uint32_t seed = 7;
+            fill_wrapped(circ, size, [&seed]
+                         { return static_cast<std::uint8_t>((seed = seed * 1664525u + 1013904223u) >> 24); });
+            REQUIRE(raphia::sum(circ) == std::accumulate(circ.begin(), circ.end(), 0ull));
+            auto mm = std::minmax_element(circ.begin(), circ.end());
+            REQUIRE(raphia::min_max(circ) == std::make_pair(*mm.first, *mm.second));
+        }
+    }
+    SECTION("floats")
+    {
+        for (std::size_t size : {1, 3, 4, 5, 9, 17, 1000})
+        {
+            raphia::circ_buffer<float> circ(1000);
+            std::uint32_t seed = 3;
+            fill_wrapped(circ, size, [&seed]
+                         { return static_cast<float>((seed = seed * 1664525u + 1013904223u) >> 20) - 2048.0f; });
+            REQUIRE(raphia::sum(circ) == Approx(std::accumulate(circ.begin(), circ.end(), 0.0)));
+            auto mm = std::minmax_element(circ.begin(), circ.end());
+            REQUIRE(raphia::min_max(circ) == std::make_pair(*mm.first, *mm.second));
+            auto value = circ[static_cast<int>(size / 2)];
+            REQUIRE(raphia::find(circ, value) == std::find(circ.cbegin(), circ.cend(), value));
+            REQUIRE(raphia::count(circ, value) == static_cast<std::size_t>(std::count(circ.begin(), circ.end(), value)));
+        }
+    }
+    SECTION("other types and containers")
+    {
+        raphia::static_circ_buffer<int, 8> circ;
+        for (int i = -5; i < 7; ++i)
+            circ.push_back(i);
+        CHECK(raphia::sum(circ) == 20);
+        CHECK(raphia::min_max(circ) == std::make_pair(-1, 6));
+        CHECK(*raphia::find(circ, 4) == 4);
+        CHECK(raphia::count(circ, 9) == 0);
+    }
+    SECTION("empty buffer")
+    {
+        raphia::circ_buffer<float> circ(8);
+        CHECK(raphia::sum(circ) == 0);
+        CHECK_THROWS_AS(raphia::min_max(circ), std::underflow_error);
+    }
+}
@@ -1,6 +1,15 @@
 #include "raphia/circ_buffer.hpp"
 #include <catch2/catch.hpp>
+#include <algorithm>
+#include <new>
+#include <numeric>
+#include <sstream>
 #include <string>
+#include <vector>
+#if defined(__unix__)
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 TEST_CASE("circ_buffer::circ_buffer()", "[ctor]")
 {
@@ -352,3 +361,728 @@ TEST_CASE("circ_buffer::iterator::operator--", "[decremenent]")
         CHECK(*iter-- == 'W');
     }
 }
+
+TEST_CASE("circ_buffer::push_front() with a capacity that is no power of two", "[modifier]")
+{
+    raphia::circ_buffer<char> circ(10);
+    std::string str = "Hello World";
+    std::copy(str.begin(), str.end(), std::front_inserter(circ));
+    SECTION("size is 10")
+    {
+        CHECK(circ.size() == 10);
+    }
+    SECTION("string has been overwritten")
+    {
+        CHECK(std::string(circ.begin(), circ.end()) == "dlroW olle");
+    }
+    SECTION("front and back are the outermost elements")
+    {
+        CHECK(circ.front() == 'd');
+        CHECK(circ.back() == 'e');
+    }
+}
+
+TEST_CASE("circ_buffer_pow2::circ_buffer_pow2(size_type)", "[ctor]")
+{
+    SECTION("capacity is rounded up to a power of two")
+    {
+        CHECK(raphia::circ_buffer_pow2<char>(0).capacity() == 0);
+        CHECK(raphia::circ_buffer_pow2<char>(1).capacity() == 1);
+        CHECK(raphia::circ_buffer_pow2<char>(5).capacity() == 8);
+        CHECK(raphia::circ_buffer_pow2<char>(512).capacity() == 512);
+        CHECK(raphia::circ_buffer_pow2<char>(513).capacity() == 1024);
+    }
+}
+
+TEST_CASE("circ_buffer_pow2::push_back()", "[modifier]")
+{
+    raphia::circ_buffer_pow2<char> circ(6);
+    SECTION("push range of elements to overflow the buffer")
+    {
+        std::string str = "Hello World";
+        std::copy(str.begin(), str.end(), std::back_inserter(circ));
+        SECTION("size is 8")
+        {
+            CHECK(circ.size() == 8);
+        }
+        SECTION("string has been overwritten")
+        {
+            CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+            CHECK(circ.front() == 'l');
+            CHECK(circ.back() == 'd');
+            CHECK(circ[1] == 'o');
+        }
+    }
+    SECTION("push to the front across the counter wrap")
+    {
+        std::string str = "Hello World";
+        std::copy(str.begin(), str.end(), std::front_inserter(circ));
+        SECTION("string has been overwritten")
+        {
+            CHECK(std::string(circ.begin(), circ.end()) == "dlroW ol");
+        }
+    }
+}
+
+TEST_CASE("circ_buffer::readable_segments()", "[segments]")
+{
+    raphia::circ_buffer<char> circ(8);
+    SECTION("empty buffer has no segments")
+    {
+        CHECK(circ.array_one().empty());
+        CHECK(circ.array_two().empty());
+    }
+    SECTION("elements that don't wrap are one segment")
+    {
+        std::string str = "Hello";
+        std::copy(str.begin(), str.end(), std::back_inserter(circ));
+        CHECK(std::string(circ.array_one().begin(), circ.array_one().end()) == "Hello");
+        CHECK(circ.array_two().empty());
+    }
+    SECTION("wrapped elements are split into two segments")
+    {
+        std::string str = "Hello World";
+        std::copy(str.begin(), str.end(), std::back_inserter(circ));
+        const auto &ref = circ;
+        auto segments = ref.readable_segments();
+        CHECK(std::string(segments[0].begin(), segments[0].end()) == "lo Wo");
+        CHECK(std::string(segments[1].begin(), segments[1].end()) == "rld");
+    }
+}
+
+TEST_CASE("circ_buffer::prepare()", "[segments]")
+{
+    raphia::circ_buffer<char> circ(8);
+    std::string str = "Hello";
+    std::copy(str.begin(), str.end(), std::back_inserter(circ));
+    circ.consume(4);
+    SECTION("consume removes elements from the front")
+    {
+        CHECK(circ.size() == 1);
+        CHECK(circ.front() == 'o');
+        circ.consume(100);
+        CHECK(circ.empty());
+    }
+    SECTION("free slots are split at the end of the buffer")
+    {
+        auto segments = circ.prepare(100);
+        CHECK(segments[0].size() == 3);
+        CHECK(segments[1].size() == 4);
+        SECTION("commit adds written elements")
+        {
+            std::copy_n("World", 3, segments[0].begin());
+            std::copy_n("ld!", 2, segments[1].begin());
+            circ.commit(5);
+            CHECK(std::string(circ.begin(), circ.end()) == "oWorld");
+        }
+        SECTION("commit is limited to the free slots")
+        {
+            circ.commit(100);
+            CHECK(circ.size() == circ.capacity());
+        }
+    }
+    SECTION("prepare returns at most the requested count")
+    {
+        auto segments = circ.prepare(2);
+        CHECK(segments[0].size() == 2);
+        CHECK(segments[1].empty());
+    }
+}
+
+#if defined(__unix__)
+TEST_CASE("circ_buffer segments with readv/writev", "[segments]")
+{
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    raphia::circ_buffer<char> circ(8);
+    std::string str = "Hello World";
+    std::copy(str.begin(), str.end(), std::back_inserter(circ));
+
+    auto readable = circ.readable_segments();
+    iovec out[2] = {{readable[0].data(), readable[0].size_bytes()}, {readable[1].data(), readable[1].size_bytes()}};
+    CHECK(::writev(fds[1], out, 2) == 8);
+    circ.consume(8);
+    CHECK(circ.empty());
+
+    auto writable = circ.prepare(circ.capacity());
+    iovec in[2] = {{writable[0].data(), writable[0].size_bytes()}, {writable[1].data(), writable[1].size_bytes()}};
+    auto received = ::readv(fds[0], in, 2);
+    CHECK(received == 8);
+    circ.commit(static_cast<std::size_t>(received));
+    CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+#endif
+
+TEST_CASE("circ_buffer::push_back(Iter, Iter)", "[modifier][bulk]")
+{
+    raphia::circ_buffer<char> circ(8);
+    std::string str = "Hello World";
+    SECTION("push a range that fits")
+    {
+        circ.push_back(str.begin(), str.begin() + 5);
+        CHECK(std::string(circ.begin(), circ.end()) == "Hello");
+        SECTION("push a range that overwrites the first elements")
+        {
+            circ.push_back(str.data() + 5, str.data() + 10);
+            CHECK(circ.size() == 8);
+            CHECK(std::string(circ.begin(), circ.end()) == "llo Worl");
+        }
+    }
+    SECTION("push a range larger than the capacity")
+    {
+        circ.push_back('x');
+        circ.push_back(str.begin(), str.end());
+        CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+    }
+    SECTION("push a range that wraps around the end of the buffer")
+    {
+        circ.push_back(str.begin(), str.begin() + 6);
+        circ.pop_front(6);
+        circ.push_back(str.begin(), str.end());
+        CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+        CHECK(circ.array_two().size() == 6);
+    }
+    SECTION("push a range that can only be read once")
+    {
+        std::istringstream stream(str);
+        circ.push_back(std::istream_iterator<char>(stream), std::istream_iterator<char>());
+        CHECK(std::string(circ.begin(), circ.end()) == "lloWorld");
+    }
+    SECTION("push an empty range")
+    {
+        circ.push_back(str.end(), str.end());
+        CHECK(circ.empty());
+    }
+}
+
+TEST_CASE("circ_buffer<class>::push_back(Iter, Iter)", "[modifier][bulk]")
+{
+    raphia::circ_buffer<std::shared_ptr<char>> circ(8);
+    auto p = std::make_shared<char>();
+    std::vector<std::shared_ptr<char>> values(5, p);
+    circ.push_back(values.begin(), values.end());
+    CHECK(p.use_count() == 11);
+    SECTION("overwritten elements are destructed")
+    {
+        circ.push_back(values.begin(), values.end());
+        CHECK(circ.size() == 8);
+        CHECK(p.use_count() == 14);
+    }
+    SECTION("pop_front(count) destructs the elements")
+    {
+        circ.pop_front(3);
+        CHECK(circ.size() == 2);
+        CHECK(p.use_count() == 8);
+        circ.pop_front(100);
+        CHECK(circ.empty());
+        CHECK(p.use_count() == 6);
+    }
+}
+
+TEST_CASE("circ_buffer::copy_out()", "[bulk]")
+{
+    raphia::circ_buffer<char> circ(8);
+    std::string str = "Hello World";
+    circ.push_back(str.begin(), str.end());
+    SECTION("copy into an array")
+    {
+        char out[16] = {};
+        CHECK(circ.copy_out(out, 16) == out + 8);
+        CHECK(std::string(out) == "lo World");
+        CHECK(circ.size() == 8);
+    }
+    SECTION("copy part of the elements into an output iterator")
+    {
+        std::string out;
+        circ.copy_out(std::back_inserter(out), 4);
+        CHECK(out == "lo W");
+    }
+}
+
+TEST_CASE("circ_buffer::iterator is a random access iterator", "[iterator]")
+{
+    using iterator = raphia::circ_buffer<int>::iterator;
+    CHECK(std::is_same<std::iterator_traits<iterator>::iterator_category, std::random_access_iterator_tag>::value);
+    CHECK(std::is_same<std::iterator_traits<iterator>::value_type, int>::value);
+    CHECK(std::is_same<std::iterator_traits<raphia::circ_buffer<int>::const_iterator>::value_type, int>::value);
+
+    std::string str = "Hello World";
+    raphia::circ_buffer<char> circ(8);
+    circ.push_back(str.begin(), str.end());
+    auto iter = circ.begin();
+    SECTION("arithmetic")
+    {
+        CHECK(*(iter + 3) == 'W');
+        CHECK(*(3 + iter) == 'W');
+        CHECK(iter[7] == 'd');
+        iter += 6;
+        CHECK(*iter == 'l');
+        iter -= 2;
+        CHECK(*iter == 'o');
+        CHECK(*(iter - 1) == 'W');
+        CHECK(circ.end() - iter == 4);
+    }
+    SECTION("comparison")
+    {
+        CHECK(iter < circ.end());
+        CHECK(iter <= iter);
+        CHECK(circ.end() > iter);
+        CHECK(circ.end() >= circ.end());
+    }
+    SECTION("conversion to const_iterator")
+    {
+        raphia::circ_buffer<char>::const_iterator citer = iter + 1;
+        CHECK(*citer == 'o');
+        CHECK(citer == circ.cbegin() + 1);
+    }
+    SECTION("reverse iteration")
+    {
+        CHECK(std::string(circ.rbegin(), circ.rend()) == "dlroW ol");
+        CHECK(std::string(circ.crbegin(), circ.crend()) == "dlroW ol");
+    }
+    SECTION("const buffer can be iterated")
+    {
+        const auto &ref = circ;
+        std::string out;
+        for (auto c : ref)
+            out += c;
+        CHECK(out == "lo World");
+    }
+}
+
+TEST_CASE("circ_buffer works with random access algorithms", "[iterator]")
+{
+    raphia::circ_buffer<int> circ(10);
+    for (int i : {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7})
+        circ.push_back(i);
+    SECTION("sort across the wrap")
+    {
+        std::sort(circ.begin(), circ.end());
+        CHECK(std::is_sorted(circ.begin(), circ.end()));
+        CHECK(*std::lower_bound(circ.begin(), circ.end(), 6) == 6);
+        CHECK(std::lower_bound(circ.begin(), circ.end(), 6) - circ.begin() == 5);
+        CHECK(circ.front() == 2);
+        CHECK(circ.back() == 9);
+    }
+    SECTION("nth_element across the wrap")
+    {
+        auto mid = circ.begin() + 5;
+        std::nth_element(circ.begin(), mid, circ.end());
+        CHECK(*mid == 6);
+    }
+}
+
+TEST_CASE("raphia::for_each_segment()", "[iterator][segments]")
+{
+    raphia::circ_buffer<int> circ(8);
+    std::vector<int> values(11);
+    std::iota(values.begin(), values.end(), 0);
+    circ.push_back(values.begin(), values.begin() + 3);
+    circ.pop_front(3);
+    circ.push_back(values.begin(), values.end());
+    SECTION("whole buffer is split at the wrap")
+    {
+        std::vector<std::size_t> sizes;
+        int sum = 0;
+        raphia::for_each_segment(circ.cbegin(), circ.cend(), [&](const int *first, const int *last)
+                                 {
+                                     sizes.push_back(static_cast<std::size_t>(last - first));
+                                     sum = std::accumulate(first, last, sum);
+                                 });
+        CHECK(sizes == std::vector<std::size_t>{5, 3});
+        CHECK(sum == std::accumulate(values.begin() + 3, values.end(), 0));
+    }
+    SECTION("part of the buffer")
+    {
+        std::vector<int> out;
+        raphia::for_each_segment(circ.begin() + 4, circ.begin() + 7, [&](int *first, int *last)
+                                 { out.insert(out.end(), first, last); });
+        CHECK(out == std::vector<int>{7, 8, 9});
+    }
+    SECTION("empty range")
+    {
+        int calls = 0;
+        raphia::for_each_segment(circ.end(), circ.end(), [&](int *, int *)
+                                 { ++calls; });
+        CHECK(calls == 0);
+    }
+}
+
+TEST_CASE("circ_buffer<class> copy and move", "[ctor]")
+{
+    auto p = std::make_shared<char>();
+    raphia::circ_buffer<std::shared_ptr<char>> circ(8);
+    for (auto _ = 5; _--;)
+        circ.push_back(p);
+    SECTION("copy constructs only the elements")
+    {
+        raphia::circ_buffer<std::shared_ptr<char>> copy(circ);
+        CHECK(copy.size() == 5);
+        CHECK(copy.capacity() == 8);
+        CHECK(p.use_count() == 11);
+    }
+    SECTION("copy assignment releases the old elements")
+    {
+        raphia::circ_buffer<std::shared_ptr<char>> copy(4);
+        copy.push_back(p);
+        copy = circ;
+        CHECK(copy.size() == 5);
+        CHECK(p.use_count() == 11);
+    }
+    SECTION("move construction takes the elements")
+    {
+        raphia::circ_buffer<std::shared_ptr<char>> moved(std::move(circ));
+        CHECK(moved.size() == 5);
+        CHECK(circ.empty());
+        CHECK(circ.capacity() == 0);
+        CHECK(p.use_count() == 6);
+    }
+    SECTION("move assignment releases the old elements")
+    {
+        raphia::circ_buffer<std::shared_ptr<char>> moved(4);
+        moved.push_back(p);
+        moved = std::move(circ);
+        CHECK(moved.size() == 5);
+        CHECK(p.use_count() == 6);
+    }
+}
+
+namespace
+{
+    /** counts live instances, the copy constructor throws once copies_left runs out */
+    struct tracked
+    {
+        static int live;
+        static int copies_left;
+        int value;
+        tracked(int v) : value(v) { ++live; }
+        tracked(const tracked &t) : value(t.value)
+        {
+            if (copies_left-- == 0)
+                throw std::runtime_error("copy failed");
+            ++live;
+        }
+        tracked &operator=(const tracked &) = default;
+        ~tracked() { --live; }
+    };
+    int tracked::live = 0;
+    int tracked::copies_left = -1;
+} // namespace
+
+TEST_CASE("circ_buffer element lifetime", "[ctor][modifier]")
+{
+    static_assert(std::is_nothrow_move_constructible<raphia::circ_buffer<std::string>>::value, "move must not throw");
+    static_assert(std::is_nothrow_move_assignable<raphia::circ_buffer<std::string>>::value, "move must not throw");
+    SECTION("copies of a wrapped trivially copyable buffer keep the order")
+    {
+        raphia::circ_buffer<int> circ(5);
+        for (int i = 0; i < 8; ++i)
+            circ.push_back(i);
+        raphia::circ_buffer<int> copy(circ);
+        CHECK(std::vector<int>(copy.begin(), copy.end()) == std::vector<int>{3, 4, 5, 6, 7});
+        raphia::circ_buffer<int> assigned(5);
+        assigned.push_back(42);
+        assigned = circ;
+        CHECK(std::vector<int>(assigned.begin(), assigned.end()) == std::vector<int>{3, 4, 5, 6, 7});
+        assigned.clear();
+        CHECK(assigned.empty());
+        assigned.push_back(1);
+        CHECK(assigned.front() == 1);
+        CHECK(assigned.size() == 1);
+    }
+    SECTION("clear and the destructor destroy every element once")
+    {
+        {
+            raphia::circ_buffer<tracked> circ(4);
+            for (int i = 0; i < 6; ++i)
+                circ.push_back(tracked(i));
+            CHECK(tracked::live == 4);
+            circ.clear();
+            CHECK(tracked::live == 0);
+            circ.push_back(tracked(1));
+            circ.push_front(tracked(0));
+            CHECK(tracked::live == 2);
+        }
+        CHECK(tracked::live == 0);
+    }
+    SECTION("a throwing copy constructor leaves nothing behind")
+    {
+        raphia::circ_buffer<tracked> circ(4);
+        for (int i = 0; i < 3; ++i)
+            circ.push_back(tracked(i));
+        tracked::copies_left = 2;
+        CHECK_THROWS_AS(raphia::circ_buffer<tracked>(circ), std::runtime_error);
+        CHECK(tracked::live == 3);
+        raphia::circ_buffer<tracked> assigned(4);
+        tracked::copies_left = 1;
+        CHECK_THROWS_AS(assigned = circ, std::runtime_error);
+        CHECK(tracked::live == 4);
+        tracked::copies_left = -1;
+        assigned.clear();
+        CHECK(tracked::live == 3);
+    }
+}
+
+TEST_CASE("circ_buffer layout policies", "[layout]")
+{
+    SECTION("packed_layout keeps the buffer in one cache line")
+    {
+        CHECK(sizeof(raphia::circ_buffer<int>) <= 64);
+    }
+    SECTION("padded_layout gives head_ and tail_ a cache line each")
+    {
+        using padded = raphia::circ_buffer_padded<int>;
+        CHECK(alignof(padded) == 64);
+        CHECK(sizeof(padded) == 3 * 64);
+        CHECK(alignof(raphia::circ_buffer_padded<int, raphia::pow2_index, 128>) == 128);
+    }
+    SECTION("padded buffers work like any other")
+    {
+        raphia::circ_buffer_padded<std::string> circ(3);
+        CHECK(reinterpret_cast<std::uintptr_t>(circ.readable_segments()[0].data()) % 64 == 0);
+        for (int i = 0; i < 5; ++i)
+            circ.push_back(std::to_string(i));
+        auto copy = circ;
+        CHECK(std::vector<std::string>(copy.begin(), copy.end()) == std::vector<std::string>{"2", "3", "4"});
+        copy.set_capacity(8);
+        CHECK(copy.capacity() == 8);
+        CHECK(copy.front() == "2");
+    }
+    SECTION("cache_aligned_allocator")
+    {
+        std::vector<int, raphia::cache_aligned_allocator<int, 128>> v;
+        for (int i = 1; i < 100; i *= 3)
+        {
+            v.resize(static_cast<std::size_t>(i));
+            CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % 128 == 0);
+        }
+        std::vector<raphia::circ_buffer_padded<int>, raphia::cache_aligned_allocator<raphia::circ_buffer_padded<int>>> buffers;
+        for (int i = 0; i < 4; ++i)
+            buffers.emplace_back(4);
+        for (auto &b : buffers)
+            CHECK(reinterpret_cast<std::uintptr_t>(&b) % 64 == 0);
+    }
+}
+
+TEST_CASE("circ_buffer stats policy", "[stats]")
+{
+    raphia::circ_buffer<int, std::allocator<int>, raphia::modulo_index, raphia::counting_stats> circ(4);
+    SECTION("no_stats adds no state")
+    {
+        CHECK(sizeof(raphia::circ_buffer<int>) == sizeof(circ) - sizeof(raphia::circ_buffer_stats));
+        CHECK(raphia::circ_buffer<int>(4).stats().pushes == 0);
+    }
+    SECTION("pushes, pops and peak size")
+    {
+        for (int i = 0; i < 3; ++i)
+            circ.push_back(i);
+        circ.pop_front();
+        circ.pop_back();
+        circ.pop_back();
+        circ.pop_back(); // empty, not counted
+        auto stats = circ.stats();
+        CHECK(stats.pushes == 3);
+        CHECK(stats.pops == 3);
+        CHECK(stats.peak_size == 3);
+        CHECK(stats.overwrites_front == 0);
+    }
+    SECTION("overwrites on both ends")
+    {
+        for (int i = 0; i < 6; ++i)
+            circ.push_back(i);
+        circ.push_front(-1);
+        circ.emblace_front(-2);
+        auto stats = circ.stats();
+        CHECK(stats.pushes == 8);
+        CHECK(stats.pops == 0);
+        CHECK(stats.overwrites_front == 2);
+        CHECK(stats.overwrites_back == 2);
+        CHECK(stats.peak_size == 4);
+    }
+    SECTION("bulk operations count elements")
+    {
+        int values[] = {1, 2, 3, 4, 5, 6};
+        circ.push_back(values, values + 3);
+        circ.push_back(values, values + 6);
+        circ.pop_front(3);
+        circ.clear(); // not counted
+        auto stats = circ.stats();
+        CHECK(stats.pushes == 9);
+        CHECK(stats.overwrites_front == 5);
+        CHECK(stats.pops == 3);
+        CHECK(stats.peak_size == 4);
+    }
+    SECTION("set_capacity, copy and reset")
+    {
+        circ.push_back(1);
+        circ.set_capacity(8);
+        auto copy = circ;
+        CHECK(copy.stats().set_capacity_calls == 1);
+        CHECK(copy.stats().pushes == 1);
+        copy.reset_stats();
+        CHECK(copy.stats().pushes == 0);
+        CHECK(circ.stats().pushes == 1);
+    }
+    SECTION("shrinking counts the dropped elements")
+    {
+        for (int i = 0; i < 4; ++i)
+            circ.push_back(i);
+        circ.set_capacity(1);
+        auto stats = circ.stats();
+        CHECK(stats.overwrites_front == 3);
+        CHECK(stats.overwrites_back == 0);
+        CHECK(stats.pops == 0);
+        CHECK(stats.set_capacity_calls == 1);
+        CHECK(circ.front() == 3);
+    }
+}
+
+namespace
+{
+    // allocator whose allocate throws while *fail is set
+    template <class T>
+    struct failing_allocator
+    {
+        using value_type = T;
+
+        explicit failing_allocator(bool *f) noexcept : fail(f) {}
+        template <class U>
+        failing_allocator(const failing_allocator<U> &a) noexcept : fail(a.fail) {}
+
+        T *allocate(std::size_t count)
+        {
+            if (*fail)
+                throw std::bad_alloc();
+            return std::allocator<T>().allocate(count);
+        }
+        void deallocate(T *p, std::size_t count) noexcept { std::allocator<T>().deallocate(p, count); }
+
+        bool *fail;
+    };
+
+    template <class T, class U>
+    bool operator==(const failing_allocator<T> &a, const failing_allocator<U> &b) noexcept { return a.fail == b.fail; }
+    template <class T, class U>
+    bool operator!=(const failing_allocator<T> &a, const failing_allocator<U> &b) noexcept { return a.fail != b.fail; }
+} // namespace
+
+TEST_CASE("circ_buffer::set_capacity() with a failing allocation", "[capacity][stats]")
+{
+    bool fail = false;
+    raphia::circ_buffer<int, failing_allocator<int>, raphia::modulo_index, raphia::counting_stats> circ(4, failing_allocator<int>(&fail));
+    for (int i = 0; i < 6; ++i)
+        circ.push_back(i);
+    auto before = circ.stats();
+    fail = true;
+    CHECK_THROWS_AS(circ.set_capacity(2), std::bad_alloc);
+    CHECK(circ.size() == 4);
+    CHECK(circ.capacity() == 4);
+    CHECK(std::vector<int>(circ.begin(), circ.end()) == std::vector<int>{2, 3, 4, 5});
+    CHECK(circ.stats().overwrites_front == before.overwrites_front);
+    CHECK(circ.stats().set_capacity_calls == before.set_capacity_calls);
+    fail = false;
+    circ.set_capacity(2);
+    CHECK(std::vector<int>(circ.begin(), circ.end()) == std::vector<int>{4, 5});
+    CHECK(circ.stats().overwrites_front == before.overwrites_front + 2);
+    CHECK(circ.stats().set_capacity_calls == before.set_capacity_calls + 1);
+}
+
+TEST_CASE("circ_buffer::set_capacity() relocates the elements", "[capacity]")
+{
+    raphia::circ_buffer<std::string> circ(4);
+    for (auto s : {"a", "b", "c", "d", "e", "f"})
+        circ.push_back(s);
+    SECTION("a full buffer that wraps keeps all elements")
+    {
+        circ.set_capacity(8);
+        CHECK(circ.capacity() == 8);
+        CHECK(std::vector<std::string>(circ.begin(), circ.end()) == std::vector<std::string>{"c", "d", "e", "f"});
+        circ.push_back("g");
+        CHECK(circ.size() == 5);
+    }
+    SECTION("shrinking keeps the last elements")
+    {
+        circ.set_capacity(2);
+        CHECK(std::vector<std::string>(circ.begin(), circ.end()) == std::vector<std::string>{"e", "f"});
+    }
+    SECTION("reserve and shrink_to_fit")
+    {
+        circ.reserve(2);
+        CHECK(circ.capacity() == 4);
+        circ.reserve(100);
+        CHECK(circ.capacity() == 100);
+        circ.pop_front();
+        circ.shrink_to_fit();
+        CHECK(circ.capacity() == 3);
+        CHECK(std::vector<std::string>(circ.begin(), circ.end()) == std::vector<std::string>{"d", "e", "f"});
+    }
+}
+
+TEST_CASE("circ_buffer_growing", "[growth]")
+{
+    SECTION("push_back grows instead of overwriting")
+    {
+        raphia::circ_buffer_growing<int> circ;
+        for (int i = 0; i < 100; ++i)
+            circ.push_back(i);
+        CHECK(circ.size() == 100);
+        CHECK(circ.capacity() == 128);
+        CHECK(circ.front() == 0);
+        CHECK(circ.back() == 99);
+    }
+    SECTION("growing keeps the order across the wrap")
+    {
+        raphia::circ_buffer_growing<std::string> circ(4);
+        for (auto s : {"x", "x", "a", "b"})
+            circ.push_back(s);
+        circ.pop_front();
+        circ.pop_front();
+        for (auto s : {"c", "d", "e"})
+            circ.push_back(s);
+        circ.push_front("z");
+        CHECK(circ.capacity() == 8);
+        CHECK(std::vector<std::string>(circ.begin(), circ.end()) == std::vector<std::string>{"z", "a", "b", "c", "d", "e"});
+    }
+    SECTION("push_front grows as well")
+    {
+        raphia::circ_buffer_growing<int, std::allocator<int>, raphia::pow2_index> circ(2);
+        for (int i = 0; i < 20; ++i)
+            circ.push_front(i);
+        CHECK(circ.size() == 20);
+        CHECK(circ.front() == 19);
+        CHECK(circ.back() == 0);
+        CHECK(circ[10] == 9);
+    }
+    SECTION("an element of the buffer can be pushed")
+    {
+        raphia::circ_buffer_growing<std::string> circ(2);
+        circ.push_back(std::string(40, 'a'));
+        circ.push_back(std::string(40, 'b'));
+        circ.push_back(circ.front());
+        circ.emblace_front(circ.back());
+        CHECK(circ.size() == 4);
+        CHECK(circ.front() == std::string(40, 'a'));
+        CHECK(circ[3] == std::string(40, 'a'));
+    }
+    SECTION("bulk push_back grows once")
+    {
+        raphia::circ_buffer_growing<char> circ(4);
+        std::string str = "Hello World";
+        circ.push_back(str.begin(), str.end());
+        circ.push_back(str.begin(), str.end());
+        CHECK(circ.size() == 22);
+        CHECK(std::string(circ.begin(), circ.end()) == str + str);
+    }
+    SECTION("elements are moved, not copied")
+    {
+        auto p = std::make_shared<char>();
+        raphia::circ_buffer_growing<std::shared_ptr<char>> circ(1);
+        for (int i = 0; i < 9; ++i)
+            circ.push_back(p);
+        CHECK(p.use_count() == 10);
+        circ.clear();
+        CHECK(p.use_count() == 1);
+    }
+}
@@ -0,0 +1,63 @@
+#include "raphia/huge_page_allocator.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <numeric>
+#if defined(__linux__)
+
+TEST_CASE("huge_page_allocator", "[allocator]")
+{
+    const std::size_t huge_page = raphia::huge_page_allocator<char>::huge_page_size;
+    raphia::huge_page_options options;
+    SECTION("blocks start at a huge page boundary and are usable")
+    {
+        // hugetlb falls back to transparent huge pages if no pages are reserved
+        for (auto mode : {raphia::huge_page_mode::none, raphia::huge_page_mode::transparent, raphia::huge_page_mode::hugetlb})
+        {
+            options.mode = mode;
+            raphia::huge_page_allocator<std::uint64_t> alloc(options);
+            const std::size_t count = huge_page / sizeof(std::uint64_t) + 1;
+            auto p = alloc.allocate(count);
+            CHECK(reinterpret_cast<std::uintptr_t>(p) % huge_page == 0);
+            std::iota(p, p + count, 0);
+            CHECK(p[count - 1] == count - 1);
+            alloc.deallocate(p, count);
+        }
+    }
+    SECTION("a circ_buffer on top of it")
+    {
+        options.prefault = false;
+        raphia::circ_buffer<std::uint64_t, raphia::huge_page_allocator<std::uint64_t>> circ(100000, raphia::huge_page_allocator<std::uint64_t>(options));
+        for (std::uint64_t i = 0; i < 250000; ++i)
+            circ.push_back(i);
+        CHECK(circ.front() == 150000);
+        CHECK(circ.back() == 249999);
+        auto copy = circ;
+        CHECK(copy.front() == 150000);
+    }
+}
+
+TEST_CASE("numa_node_mask", "[allocator]")
+{
+    const std::size_t bits = 8 * sizeof(unsigned long);
+    // the kernel reads maxnode - 1 bits of the mask, the last bit of a word has to be among them
+    for (int node : {0, 1, 63, 64, 127, 1000})
+    {
+        raphia::numa_node_mask mask(node);
+        auto n = static_cast<std::size_t>(node);
+        CHECK(mask.nodes.size() == n / bits + 1);
+        CHECK(((mask.nodes[n / bits] >> (n % bits)) & 1ul) == 1ul);
+        CHECK(n < mask.maxnode - 1);
+        CHECK(mask.maxnode - 1 <= mask.nodes.size() * bits);
+    }
+}
+
+TEST_CASE("huge_page_allocator binds to a NUMA node", "[allocator]")
+{
+    raphia::huge_page_options options;
+    options.numa_node = 1000;
+    raphia::huge_page_allocator<char> alloc(options);
+    CHECK_THROWS_AS(alloc.allocate(1), std::system_error);
+    CHECK(alloc != raphia::huge_page_allocator<int>());
+    CHECK(raphia::huge_page_allocator<char>() == raphia::huge_page_allocator<int>());
+}
+#endif
@@ -0,0 +1,127 @@
+#include "raphia/mapped_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#if defined(__unix__)
+#include <csignal>
+#include <sys/wait.h>
+
+namespace
+{
+    struct temp_file
+    {
+        temp_file() : path("/tmp/raphia_mapped_" + std::to_string(::getpid()) + ".ring") { ::unlink(path.c_str()); }
+        ~temp_file() { ::unlink(path.c_str()); }
+        std::string path;
+    };
+
+    struct event
+    {
+        std::uint64_t sequence;
+        std::uint64_t check;
+    };
+} // namespace
+
+TEST_CASE("mapped_circ_buffer::mapped_circ_buffer()", "[mapped][ctor]")
+{
+    temp_file file;
+    SECTION("a new file is empty")
+    {
+        raphia::mapped_circ_buffer<int> circ(file.path, 10);
+        CHECK(circ.empty());
+        CHECK(circ.capacity() == 10);
+        CHECK_THROWS_AS(circ.front(), std::underflow_error);
+    }
+    SECTION("an existing file keeps its capacity and content")
+    {
+        {
+            raphia::mapped_circ_buffer<int> circ(file.path, 4);
+            for (int i = 0; i < 6; ++i)
+                circ.push_back(i);
+        }
+        raphia::mapped_circ_buffer<int> circ(file.path, 100);
+        CHECK(circ.capacity() == 4);
+        CHECK(std::vector<int>(circ.begin(), circ.end()) == std::vector<int>{2, 3, 4, 5});
+    }
+    SECTION("a file of another element type is rejected")
+    {
+        {
+            raphia::mapped_circ_buffer<int> circ(file.path, 4);
+        }
+        CHECK_THROWS_AS(raphia::mapped_circ_buffer<double>(file.path, 4), std::runtime_error);
+    }
+    SECTION("a file that is no buffer is rejected")
+    {
+        {
+            raphia::mapped_circ_buffer<int> circ(file.path, 4);
+        }
+        auto fd = ::open(file.path.c_str(), O_WRONLY);
+        REQUIRE(::write(fd, "garbage!", 8) == 8);
+        ::close(fd);
+        CHECK_THROWS_AS(raphia::mapped_circ_buffer<int>(file.path, 4), std::runtime_error);
+    }
+    SECTION("a missing directory throws")
+    {
+        CHECK_THROWS_AS(raphia::mapped_circ_buffer<int>("/nonexistent/dir/ring", 4), std::system_error);
+    }
+}
+
+TEST_CASE("mapped_circ_buffer modifiers", "[mapped][modifier]")
+{
+    temp_file file;
+    raphia::mapped_circ_buffer<int, raphia::pow2_index> circ(file.path, 5);
+    CHECK(circ.capacity() == 8);
+    for (int i = 0; i < 10; ++i)
+        circ.push_back(i);
+    CHECK(circ.size() == 8);
+    CHECK(circ.front() == 2);
+    CHECK(circ.back() == 9);
+    CHECK(circ.at(3) == 5);
+    CHECK_THROWS_AS(circ.at(8), std::out_of_range);
+    auto segments = circ.readable_segments();
+    CHECK(segments[0].size() + segments[1].size() == 8);
+    CHECK(segments[1].size() == 2);
+    circ.pop_front();
+    CHECK(circ.front() == 3);
+    circ.sync();
+    circ.clear();
+    CHECK(circ.empty());
+    raphia::mapped_circ_buffer<int, raphia::pow2_index> moved(std::move(circ));
+    moved.push_back(42);
+    CHECK(moved.front() == 42);
+}
+
+TEST_CASE("mapped_circ_buffer survives a killed writer", "[mapped]")
+{
+    temp_file file;
+    {
+        raphia::mapped_circ_buffer<event> circ(file.path, 1000);
+    }
+    auto pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // the child writes until it gets killed, without ever closing the buffer
+        raphia::mapped_circ_buffer<event> circ(file.path, 1000);
+        for (std::uint64_t i = 0;; ++i)
+            circ.push_back({i, ~i});
+    }
+    ::usleep(20000);
+    ::kill(pid, SIGKILL);
+    int status;
+    ::waitpid(pid, &status, 0);
+    REQUIRE(WIFSIGNALED(status));
+
+    raphia::mapped_circ_buffer<event> circ(file.path, 1000);
+    REQUIRE(!circ.empty());
+    auto first = circ.front().sequence;
+    std::uint64_t expected = first;
+    for (auto &e : circ)
+    {
+        REQUIRE(e.sequence == expected);
+        REQUIRE(e.check == ~expected);
+        ++expected;
+    }
+}
+#endif
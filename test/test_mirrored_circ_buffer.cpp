@@ -0,0 +1,107 @@
+#include "raphia/mirrored_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#if defined(__linux__)
+
+TEST_CASE("mirrored_circ_buffer::mirrored_circ_buffer(size_type)", "[mirrored][ctor]")
+{
+    auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    SECTION("capacity is rounded up to whole pages")
+    {
+        CHECK(raphia::mirrored_circ_buffer<char>(1).capacity() == page);
+        CHECK(raphia::mirrored_circ_buffer<char>(page + 1).capacity() == 2 * page);
+        CHECK(raphia::mirrored_circ_buffer<std::uint32_t>(10).capacity() == page / 4);
+    }
+    SECTION("capacity holds whole elements")
+    {
+        struct odd
+        {
+            char c[3];
+        };
+        raphia::mirrored_circ_buffer<odd> circ(1);
+        CHECK(circ.capacity() * sizeof(odd) % page == 0);
+    }
+    raphia::mirrored_circ_buffer<char> circ(64);
+    SECTION("is empty")
+    {
+        CHECK(circ.empty());
+        CHECK(circ.span().empty());
+        CHECK_THROWS(circ.front());
+    }
+}
+
+TEST_CASE("mirrored_circ_buffer keeps wrapped elements contiguous", "[mirrored][span]")
+{
+    raphia::mirrored_circ_buffer<char> circ(1);
+    std::string str = "Hello World";
+    SECTION("elements wrap at the end of the buffer")
+    {
+        // leave only 5 slots in front of the physical end of the buffer
+        for (std::size_t i = 0; i < circ.capacity() - 5; ++i)
+            circ.push_back('x');
+        while (!circ.empty())
+            circ.pop_front();
+        for (auto c : str)
+            circ.push_back(c);
+        SECTION("data() spans across the end")
+        {
+            CHECK(std::string(circ.data(), circ.size()) == str);
+            CHECK(std::string(circ.begin(), circ.end()) == str);
+            auto s = circ.span();
+            CHECK(std::string(s.begin(), s.end()) == str);
+        }
+        SECTION("accessors see the wrapped elements")
+        {
+            CHECK(circ.front() == 'H');
+            CHECK(circ.back() == 'd');
+            CHECK(circ[6] == 'W');
+            CHECK_THROWS_AS(circ.at(str.size()), std::out_of_range);
+        }
+        SECTION("the span can be written with one call")
+        {
+            int fds[2];
+            REQUIRE(::pipe(fds) == 0);
+            CHECK(::write(fds[1], circ.data(), circ.size()) == static_cast<ssize_t>(str.size()));
+            char out[32] = {};
+            CHECK(::read(fds[0], out, sizeof(out)) == static_cast<ssize_t>(str.size()));
+            CHECK(std::string(out) == str);
+            ::close(fds[0]);
+            ::close(fds[1]);
+        }
+    }
+    SECTION("overflow the buffer")
+    {
+        for (std::size_t i = 0; i < circ.capacity(); ++i)
+            circ.push_back('x');
+        for (auto c : str)
+            circ.push_back(c);
+        CHECK(circ.size() == circ.capacity());
+        CHECK(std::string(circ.end() - str.size(), circ.end()) == str);
+    }
+    SECTION("push to the front")
+    {
+        for (auto c : str)
+            circ.push_front(c);
+        CHECK(std::string(circ.begin(), circ.end()) == "dlroW olleH");
+    }
+}
+
+TEST_CASE("mirrored_circ_buffer move", "[mirrored][ctor]")
+{
+    raphia::mirrored_circ_buffer<std::uint64_t> circ(8);
+    for (std::uint64_t i = 0; i < 5; ++i)
+        circ.push_back(i);
+    circ.pop_front();
+    auto moved = std::move(circ);
+    CHECK(moved.size() == 4);
+    CHECK(moved.front() == 1);
+    CHECK(circ.capacity() == 0);
+}
+
+TEST_CASE("mirrored_circ_buffer rejects counts beyond the address space", "[mirrored][ctor]")
+{
+    CHECK_THROWS_AS(raphia::mirrored_circ_buffer<std::uint64_t>(static_cast<std::size_t>(-1) / 4), std::length_error);
+    CHECK_THROWS_AS(raphia::mirrored_circ_buffer<char>(static_cast<std::size_t>(-1) / 2), std::length_error);
+}
+#endif
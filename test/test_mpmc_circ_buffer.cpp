@@ -0,0 +1,154 @@
+#include "raphia/mpmc_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("mpmc_circ_buffer::mpmc_circ_buffer(size_type)", "[mpmc][ctor]")
+{
+    SECTION("capacity below 2 throws")
+    {
+        CHECK_THROWS_AS(raphia::mpmc_circ_buffer<char>(1), std::invalid_argument);
+    }
+    raphia::mpmc_circ_buffer<char> circ(512);
+    SECTION("capacity is 512")
+    {
+        CHECK(circ.capacity() == 512);
+    }
+    SECTION("is empty")
+    {
+        CHECK(circ.empty());
+        char c;
+        CHECK(!circ.try_pop(c));
+    }
+}
+
+TEST_CASE("mpmc_circ_buffer::try_push()", "[mpmc][modifier]")
+{
+    raphia::mpmc_circ_buffer<std::string> circ(3);
+    CHECK(circ.try_push("Hello"));
+    CHECK(circ.try_push(std::string("World")));
+    CHECK(circ.try_emplace(3, 'a'));
+    SECTION("push into the full buffer fails instead of overwriting")
+    {
+        CHECK(!circ.try_push("lost"));
+        CHECK(circ.size() == 3);
+    }
+    SECTION("pop the elements in order over several laps")
+    {
+        std::string str;
+        for (auto _ = 4; _--;)
+        {
+            CHECK(circ.try_pop(str));
+            CHECK(str == "Hello");
+            CHECK(circ.try_pop(str));
+            CHECK(str == "World");
+            CHECK(circ.try_pop(str));
+            CHECK(str == "aaa");
+            CHECK(!circ.try_pop(str));
+            circ.push("Hello");
+            circ.emplace("World");
+            circ.emplace(3, 'a');
+        }
+    }
+}
+
+TEST_CASE("mpmc_circ_buffer destroys remaining elements", "[mpmc][dtor]")
+{
+    auto p = std::make_shared<char>();
+    {
+        raphia::mpmc_circ_buffer<std::shared_ptr<char>> circ(8);
+        for (auto _ = 5; _--;)
+            circ.push(p);
+        CHECK(p.use_count() == 6);
+    }
+    CHECK(p.use_count() == 1);
+}
+
+TEMPLATE_TEST_CASE("mpmc_circ_buffer producer and consumer threads", "[mpmc][thread]",
+                   (raphia::mpmc_circ_buffer<std::size_t>),
+                   (raphia::mpmc_circ_buffer<std::size_t, std::allocator<std::size_t>, raphia::pow2_index>))
+{
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t consumers = 3;
+    constexpr std::size_t count = 20000;
+    TestType circ(30);
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p)
+        threads.emplace_back([&circ, p]
+                             {
+                                 for (std::size_t i = 0; i < count; ++i)
+                                     circ.push(p * count + i);
+                             });
+    std::vector<std::vector<std::size_t>> received(consumers);
+    for (std::size_t c = 0; c < consumers; ++c)
+        threads.emplace_back([&circ, &received, c]
+                             {
+                                 for (std::size_t i = c; i < producers * count; i += consumers)
+                                 {
+                                     std::size_t value;
+                                     circ.pop(value);
+                                     received[c].push_back(value);
+                                 }
+                             });
+    for (auto &t : threads)
+        t.join();
+
+    // every value arrives exactly once and the values of one producer stay in order
+    std::vector<std::size_t> seen(producers * count);
+    bool ordered = true;
+    for (auto &values : received)
+    {
+        std::vector<std::size_t> last(producers, 0);
+        for (auto value : values)
+        {
+            ++seen[value];
+            auto p = value / count;
+            if (value % count < last[p])
+                ordered = false;
+            last[p] = value % count;
+        }
+    }
+    CHECK(std::all_of(seen.begin(), seen.end(), [](std::size_t n)
+                      { return n == 1; }));
+    CHECK(ordered);
+    CHECK(circ.empty());
+}
+
+namespace
+{
+    struct throwing
+    {
+        int value;
+
+        explicit throwing(int v = 0) : value(v)
+        {
+            if (v < 0)
+                throw std::runtime_error("throwing: negative value");
+        }
+        throwing(const throwing &other) : throwing(other.value) {}
+        throwing(throwing &&other) noexcept : value(other.value) {}
+        throwing &operator=(const throwing &) = default;
+        throwing &operator=(throwing &&) noexcept = default;
+    };
+} // namespace
+
+TEST_CASE("mpmc_circ_buffer with a throwing constructor", "[mpmc][modifier]")
+{
+    raphia::mpmc_circ_buffer<throwing> circ(2);
+    CHECK(circ.try_emplace(1));
+    CHECK_THROWS_AS(circ.try_emplace(-1), std::runtime_error);
+    CHECK_THROWS_AS(circ.emplace(-2), std::runtime_error);
+    // the failed pushes neither claimed a slot nor left one unpublished
+    CHECK(circ.size() == 1);
+    circ.push(throwing(2));
+    CHECK(!circ.try_emplace(3));
+    throwing t;
+    circ.pop(t);
+    CHECK(t.value == 1);
+    circ.pop(t);
+    CHECK(t.value == 2);
+    CHECK(!circ.try_pop(t));
+}
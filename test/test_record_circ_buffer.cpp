@@ -0,0 +1,132 @@
+#include "raphia/record_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+    std::string str(raphia::span<const unsigned char> record)
+    {
+        return std::string(reinterpret_cast<const char *>(record.data()), record.size());
+    }
+
+    void push(raphia::record_circ_buffer<> &circ, const std::string &s)
+    {
+        circ.push_back(s.data(), s.size());
+    }
+} // namespace
+
+TEST_CASE("record_circ_buffer::record_circ_buffer(size_type)", "[record][ctor]")
+{
+    raphia::record_circ_buffer<> circ(30);
+    CHECK(circ.capacity() == 32);
+    CHECK(circ.empty());
+    CHECK_THROWS_AS(circ.peek(), std::underflow_error);
+    CHECK_THROWS_AS(circ.reserve(29), std::length_error);
+}
+
+TEST_CASE("record_circ_buffer records", "[record][modifier]")
+{
+    // every record takes 4 header bytes, rounded up to a multiple of 4
+    raphia::record_circ_buffer<> circ(32);
+    SECTION("records come out in order")
+    {
+        push(circ, "Hello");
+        push(circ, "");
+        push(circ, "World");
+        CHECK(circ.size() == 3);
+        CHECK(str(circ.peek()) == "Hello");
+        circ.pop_front();
+        CHECK(str(circ.peek()).empty());
+        circ.pop_front();
+        CHECK(str(circ.peek()) == "World");
+        circ.pop_front();
+        CHECK(circ.empty());
+        circ.pop_front();
+        CHECK(circ.empty());
+    }
+    SECTION("reserve and commit a shorter record")
+    {
+        auto record = circ.reserve(20);
+        CHECK(record.size() == 20);
+        std::memcpy(record.data(), "abc", 3);
+        circ.commit(3);
+        CHECK(str(circ.peek()) == "abc");
+        push(circ, std::string(12, 'x')); // 16 bytes, fits behind the 8 bytes of "abc"
+        CHECK(circ.evicted() == 0);
+        CHECK(circ.size() == 2);
+    }
+    SECTION("a record that doesn't fit at the end starts over at the beginning")
+    {
+        push(circ, "0123456789"); // 16 bytes
+        auto begin = circ.peek().data();
+        push(circ, "abc"); // 8 bytes
+        circ.pop_front();
+        push(circ, "0123456789ab"); // 16 bytes, only 8 left at the end
+        CHECK(circ.evicted() == 0);
+        CHECK(str(circ.peek()) == "abc");
+        circ.pop_front();
+        CHECK(str(circ.peek()) == "0123456789ab");
+        CHECK(circ.peek().data() == begin);
+    }
+    SECTION("a full buffer evicts whole records")
+    {
+        push(circ, "0123"); // 8 bytes each
+        push(circ, "4567");
+        push(circ, "89ab");
+        push(circ, "cdef");
+        push(circ, std::string(10, 'x')); // 16 bytes, evicts two records
+        CHECK(circ.evicted() == 2);
+        CHECK(circ.size() == 3);
+        CHECK(str(circ.peek()) == "89ab");
+    }
+    SECTION("clear")
+    {
+        push(circ, "abc");
+        circ.clear();
+        CHECK(circ.empty());
+        push(circ, std::string(28, 'y'));
+        CHECK(circ.peek().size() == 28);
+    }
+}
+
+TEST_CASE("record_circ_buffer keeps records intact", "[record]")
+{
+    raphia::record_circ_buffer<> circ(1000);
+    std::mt19937 rng(7);
+    std::uint32_t next = 0, expected = 0;
+    std::size_t popped = 0;
+    bool intact = true;
+    for (int round = 0; round < 20000; ++round)
+    {
+        if (rng() % 3)
+        {
+            // the record holds its sequence number, followed by a fill pattern
+            auto length = sizeof(next) + rng() % 200;
+            auto record = circ.reserve(length);
+            std::memcpy(record.data(), &next, sizeof(next));
+            for (auto i = sizeof(next); i < length; ++i)
+                record[i] = static_cast<unsigned char>(next + i);
+            circ.commit(length);
+            ++next;
+        }
+        else if (!circ.empty())
+        {
+            auto record = circ.peek();
+            std::uint32_t sequence;
+            std::memcpy(&sequence, record.data(), sizeof(sequence));
+            // evicted records only ever leave gaps, never reorder
+            intact = intact && sequence >= expected;
+            for (auto i = sizeof(sequence); i < record.size(); ++i)
+                intact = intact && record[i] == static_cast<unsigned char>(sequence + i);
+            expected = sequence + 1;
+            circ.pop_front();
+            ++popped;
+        }
+    }
+    CHECK(intact);
+    CHECK(circ.evicted() > 0);
+    CHECK(popped + circ.evicted() + circ.size() == next);
+}
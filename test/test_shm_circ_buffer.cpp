@@ -0,0 +1,146 @@
+#include "raphia/shm_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <thread>
+#if defined(__linux__)
+#include <sys/wait.h>
+
+namespace
+{
+    struct shm_name
+    {
+        shm_name() : name("/raphia_test_" + std::to_string(::getpid())) { raphia::shm_circ_buffer<int>::remove(name); }
+        ~shm_name() { raphia::shm_circ_buffer<int>::remove(name); }
+        std::string name;
+    };
+
+    struct event
+    {
+        std::uint64_t sequence;
+        std::uint64_t check;
+    };
+} // namespace
+
+TEST_CASE("shm_circ_buffer::shm_circ_buffer()", "[shm][ctor]")
+{
+    shm_name shm;
+    SECTION("a new segment is empty")
+    {
+        raphia::shm_circ_buffer<int, raphia::pow2_index> circ(shm.name, 5);
+        CHECK(circ.empty());
+        CHECK(circ.capacity() == 8);
+    }
+    SECTION("an existing segment can't be created again")
+    {
+        raphia::shm_circ_buffer<int> circ(shm.name, 4);
+        CHECK_THROWS_AS(raphia::shm_circ_buffer<int>(shm.name, 4), std::system_error);
+    }
+    SECTION("opening shares the buffer")
+    {
+        raphia::shm_circ_buffer<int> writer(shm.name, 4);
+        raphia::shm_circ_buffer<int> reader(shm.name);
+        CHECK(reader.capacity() == 4);
+        CHECK(writer.try_push(1));
+        CHECK(reader.size() == 1);
+        int a = 0;
+        CHECK(reader.try_pop(a));
+        CHECK(a == 1);
+        CHECK(writer.empty());
+    }
+    SECTION("a segment of another element type is rejected")
+    {
+        raphia::shm_circ_buffer<int> circ(shm.name, 4);
+        CHECK_THROWS_AS(raphia::shm_circ_buffer<double>(shm.name), std::runtime_error);
+    }
+    SECTION("a capacity the index policy can't map is rejected")
+    {
+        raphia::shm_circ_buffer<int> circ(shm.name, 3);
+        CHECK_THROWS_AS((raphia::shm_circ_buffer<int, raphia::pow2_index>(shm.name)), std::runtime_error);
+    }
+    SECTION("a missing segment throws")
+    {
+        CHECK_THROWS_AS(raphia::shm_circ_buffer<int>(shm.name), std::system_error);
+    }
+    SECTION("remove")
+    {
+        {
+            raphia::shm_circ_buffer<int> circ(shm.name, 4);
+        }
+        CHECK(raphia::shm_circ_buffer<int>::remove(shm.name));
+        CHECK_FALSE(raphia::shm_circ_buffer<int>::remove(shm.name));
+    }
+}
+
+TEST_CASE("shm_circ_buffer full and empty", "[shm][modifier]")
+{
+    shm_name shm;
+    raphia::shm_circ_buffer<int> circ(shm.name, 3);
+    int a = 0;
+    CHECK_FALSE(circ.try_pop(a));
+    for (int i = 0; i < 3; ++i)
+        CHECK(circ.try_push(i));
+    CHECK_FALSE(circ.try_push(3));
+    CHECK(circ.size() == 3);
+    // wraps around several times
+    for (int i = 3; i < 20; ++i)
+    {
+        REQUIRE(circ.try_pop(a));
+        CHECK(a == i - 3);
+        REQUIRE(circ.try_push(i));
+    }
+    raphia::shm_circ_buffer<int> moved(std::move(circ));
+    CHECK(moved.size() == 3);
+}
+
+TEST_CASE("shm_circ_buffer between two processes", "[shm]")
+{
+    shm_name shm;
+    const std::uint64_t count = 200000;
+    raphia::shm_circ_buffer<event> reader(shm.name, 64);
+    auto pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0)
+    {
+        // nothing may escape into Catch, the child would go on running the suite
+        try
+        {
+            raphia::shm_circ_buffer<event> writer(shm.name);
+            for (std::uint64_t i = 0; i < count; ++i)
+                writer.push({i, ~i});
+        }
+        catch (...)
+        {
+            ::_exit(1);
+        }
+        ::_exit(0);
+    }
+    // stop once the child has exited and the buffer is drained, so a dead child fails the test instead of hanging it
+    bool ordered = true;
+    bool exited = false;
+    int status = 0;
+    std::uint64_t received = 0;
+    while (received < count)
+    {
+        event e;
+        if (reader.try_pop(e))
+        {
+            ordered = ordered && e.sequence == received && e.check == ~received;
+            ++received;
+        }
+        else if (exited)
+            break;
+        else if (::waitpid(pid, &status, WNOHANG) == pid)
+            exited = true;
+        else
+            std::this_thread::yield();
+    }
+    if (!exited)
+        ::waitpid(pid, &status, 0);
+    CHECK(received == count);
+    CHECK(ordered);
+    CHECK(reader.empty());
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+}
+#endif
@@ -0,0 +1,101 @@
+#include "raphia/soa_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    // timestamp, price, qty, flags
+    using tick_buffer = raphia::soa_circ_buffer<std::int64_t, double, std::uint32_t, std::uint8_t>;
+} // namespace
+
+TEST_CASE("soa_circ_buffer::soa_circ_buffer(size_type)", "[soa][ctor]")
+{
+    tick_buffer circ(5);
+    CHECK(circ.capacity() == 5);
+    CHECK(circ.empty());
+    CHECK_THROWS_AS(circ.front(), std::underflow_error);
+    CHECK_THROWS_AS(circ.at(0), std::out_of_range);
+    CHECK(circ.segments<1>()[0].empty());
+    raphia::basic_soa_circ_buffer<raphia::pow2_index, int, int> pow2(5);
+    CHECK(pow2.capacity() == 8);
+}
+
+TEST_CASE("soa_circ_buffer::push_back()", "[soa][modifier]")
+{
+    tick_buffer circ(4);
+    for (int i = 0; i < 6; ++i)
+        circ.push_back(i, i * 0.5, static_cast<std::uint32_t>(i * 10), static_cast<std::uint8_t>(i & 1));
+    SECTION("overwrites the oldest record when full")
+    {
+        CHECK(circ.size() == 4);
+        CHECK(circ.front() == std::make_tuple(std::int64_t(2), 1.0, std::uint32_t(20), std::uint8_t(0)));
+        CHECK(circ.back() == std::make_tuple(std::int64_t(5), 2.5, std::uint32_t(50), std::uint8_t(1)));
+        CHECK(circ.get<2>(1) == 30);
+        CHECK(std::get<1>(circ[3]) == 2.5);
+    }
+    SECTION("push a tuple")
+    {
+        circ.push_back(std::make_tuple(std::int64_t(6), 3.0, std::uint32_t(60), std::uint8_t(0)));
+        CHECK(circ.get<0>(3) == 6);
+        CHECK(circ.get<0>(0) == 3);
+    }
+    SECTION("columns are split into two segments when wrapped")
+    {
+        auto segments = circ.segments<0>();
+        CHECK(segments[0].size() == 2);
+        CHECK(segments[1].size() == 2);
+        CHECK(segments[0][0] == 2);
+        CHECK(segments[1][1] == 5);
+        CHECK(reinterpret_cast<std::uintptr_t>(segments[1].data()) % 64 == 0);
+    }
+    SECTION("for_each visits one column in order")
+    {
+        std::vector<std::uint32_t> qty;
+        circ.for_each<2>([&qty](std::uint32_t q) { qty.push_back(q); });
+        CHECK(qty == std::vector<std::uint32_t>{20, 30, 40, 50});
+        double sum = 0;
+        circ.for_each<1>([&sum](double p) { sum += p; });
+        CHECK(sum == 7.0);
+    }
+    SECTION("a column can be written through get")
+    {
+        circ.get<1>(0) = 9.5;
+        CHECK(std::get<1>(circ.front()) == 9.5);
+    }
+    SECTION("pop_front")
+    {
+        circ.pop_front();
+        CHECK(circ.get<0>(0) == 3);
+        circ.pop_front(10);
+        CHECK(circ.empty());
+        circ.pop_front();
+        CHECK(circ.empty());
+    }
+}
+
+TEST_CASE("soa_circ_buffer copy and move", "[soa][ctor]")
+{
+    tick_buffer circ(3);
+    for (int i = 0; i < 5; ++i)
+        circ.push_back(i, i, static_cast<std::uint32_t>(i), std::uint8_t(0));
+    tick_buffer copy(circ);
+    CHECK(copy.size() == 3);
+    CHECK(copy.get<0>(0) == 2);
+    CHECK(copy.segments<0>()[1].empty());
+    tick_buffer assigned(3);
+    assigned = circ;
+    CHECK(assigned.get<3>(2) == 0);
+    CHECK(assigned.get<0>(2) == 4);
+    tick_buffer other(7);
+    other = circ;
+    CHECK(other.capacity() == 3);
+    CHECK(other.get<0>(1) == 3);
+    tick_buffer moved(std::move(circ));
+    CHECK(moved.size() == 3);
+    CHECK(circ.capacity() == 0);
+    circ.push_back(1, 1, 1u, std::uint8_t(1));
+    CHECK(circ.empty());
+    circ = std::move(moved);
+    CHECK(circ.get<0>(2) == 4);
+}
@@ -0,0 +1,108 @@
+#include "raphia/circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <string>
+#include <thread>
+
+TEST_CASE("spsc_circ_buffer::spsc_circ_buffer(size_type)", "[spsc][ctor]")
+{
+    raphia::spsc_circ_buffer<char> circ(512);
+    SECTION("size is 0")
+    {
+        CHECK(circ.size() == 0);
+    }
+    SECTION("capacity is 512")
+    {
+        CHECK(circ.capacity() == 512);
+    }
+    SECTION("is empty")
+    {
+        CHECK(circ.empty());
+    }
+    SECTION("pop fails")
+    {
+        char c;
+        CHECK(!circ.try_pop(c));
+    }
+}
+
+TEST_CASE("spsc_circ_buffer::try_push()", "[spsc][modifier]")
+{
+    raphia::spsc_circ_buffer<std::string> circ(4);
+    SECTION("fill the buffer")
+    {
+        CHECK(circ.try_push("Hello"));
+        CHECK(circ.try_push(std::string("World")));
+        CHECK(circ.try_emplace(3, 'a'));
+        CHECK(circ.try_emplace("!"));
+        SECTION("size is 4")
+        {
+            CHECK(circ.size() == 4);
+        }
+        SECTION("push into the full buffer fails instead of overwriting")
+        {
+            CHECK(!circ.try_push("lost"));
+            CHECK(circ.size() == 4);
+        }
+        SECTION("pop the elements in order")
+        {
+            std::string str;
+            CHECK(circ.try_pop(str));
+            CHECK(str == "Hello");
+            CHECK(circ.try_pop(str));
+            CHECK(str == "World");
+            CHECK(circ.try_pop(str));
+            CHECK(str == "aaa");
+            CHECK(circ.try_pop(str));
+            CHECK(str == "!");
+            CHECK(!circ.try_pop(str));
+            CHECK(circ.empty());
+        }
+        SECTION("push succeeds again after a pop")
+        {
+            std::string str;
+            CHECK(circ.try_pop(str));
+            CHECK(circ.try_push("again"));
+        }
+    }
+}
+
+TEST_CASE("spsc_circ_buffer destroys remaining elements", "[spsc][dtor]")
+{
+    auto p = std::make_shared<char>();
+    {
+        raphia::spsc_circ_buffer<std::shared_ptr<char>> circ(8);
+        for (auto _ = 5; _--;)
+            circ.try_push(p);
+        std::shared_ptr<char> out;
+        circ.try_pop(out);
+        out.reset();
+        CHECK(p.use_count() == 5);
+    }
+    CHECK(p.use_count() == 1);
+}
+
+TEMPLATE_TEST_CASE("spsc_circ_buffer producer and consumer thread", "[spsc][thread]",
+                   (raphia::spsc_circ_buffer<std::size_t>),
+                   (raphia::spsc_circ_buffer<std::size_t, std::allocator<std::size_t>, raphia::pow2_index>))
+{
+    constexpr std::size_t count = 200000;
+    TestType circ(100);
+    std::thread producer([&circ]
+                         {
+                             for (std::size_t i = 0; i < count; ++i)
+                                 while (!circ.try_push(i))
+                                     std::this_thread::yield();
+                         });
+    std::size_t mismatches = 0;
+    for (std::size_t expected = 0; expected < count; ++expected)
+    {
+        std::size_t value;
+        while (!circ.try_pop(value))
+            std::this_thread::yield();
+        if (value != expected)
+            ++mismatches;
+    }
+    producer.join();
+    CHECK(mismatches == 0);
+    CHECK(circ.empty());
+}
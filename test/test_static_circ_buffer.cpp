@@ -0,0 +1,157 @@
+#include "raphia/static_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <string>
+
+TEST_CASE("static_circ_buffer::static_circ_buffer()", "[static][ctor]")
+{
+    raphia::static_circ_buffer<char, 8> circ;
+    SECTION("size is 0")
+    {
+        CHECK(circ.size() == 0);
+    }
+    SECTION("capacity is 8")
+    {
+        CHECK(circ.capacity() == 8);
+        CHECK(raphia::static_circ_buffer<char, 8>::capacity() == 8);
+    }
+    SECTION("is empty")
+    {
+        CHECK(circ.empty());
+        CHECK(circ.begin() == circ.end());
+    }
+    SECTION("back and front throw")
+    {
+        CHECK_THROWS(circ.front());
+        CHECK_THROWS(circ.back());
+    }
+    SECTION("storage is inline")
+    {
+        CHECK(sizeof(circ) == 2 * sizeof(std::size_t) + 8);
+    }
+}
+
+TEST_CASE("static_circ_buffer::push_back()", "[static][modifier]")
+{
+    raphia::static_circ_buffer<char, 8> circ;
+    std::string str = "Hello World";
+    SECTION("push range of elements to overflow the buffer")
+    {
+        std::copy(str.begin(), str.end(), std::back_inserter(circ));
+        CHECK(circ.size() == 8);
+        CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+        CHECK(circ.front() == 'l');
+        CHECK(circ.back() == 'd');
+        CHECK(circ[3] == 'W');
+        CHECK_THROWS_AS(circ.at(8), std::out_of_range);
+        SECTION("segments split at the wrap")
+        {
+            CHECK(std::string(circ.array_one().begin(), circ.array_one().end()) == "lo Wo");
+            CHECK(std::string(circ.array_two().begin(), circ.array_two().end()) == "rld");
+        }
+        SECTION("reverse iteration")
+        {
+            CHECK(std::string(circ.rbegin(), circ.rend()) == "dlroW ol");
+        }
+        SECTION("bulk removal and copy")
+        {
+            char out[8] = {};
+            circ.pop_front(3);
+            circ.copy_out(out, 8);
+            CHECK(std::string(out) == "World");
+        }
+    }
+    SECTION("push a range")
+    {
+        circ.push_back(str.begin(), str.end());
+        CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+    }
+}
+
+TEST_CASE("static_circ_buffer::push_front() with a capacity that is no power of two", "[static][modifier]")
+{
+    raphia::static_circ_buffer<char, 10> circ;
+    std::string str = "Hello World";
+    std::copy(str.begin(), str.end(), std::front_inserter(circ));
+    CHECK(std::string(circ.begin(), circ.end()) == "dlroW olle");
+    std::sort(circ.begin(), circ.end());
+    CHECK(std::string(circ.begin(), circ.end()) == " Wdellloor");
+}
+
+TEST_CASE("static_circ_buffer::prepare()", "[static][segments]")
+{
+    raphia::static_circ_buffer<char, 8> circ;
+    circ.push_back('x');
+    circ.consume(1);
+    auto segments = circ.prepare(100);
+    CHECK(segments[0].size() == 7);
+    CHECK(segments[1].size() == 1);
+    std::copy_n("Hello World", 7, segments[0].begin());
+    circ.commit(7);
+    CHECK(std::string(circ.begin(), circ.end()) == "Hello W");
+}
+
+TEST_CASE("static_circ_buffer<class> lifetime", "[static][dtor]")
+{
+    auto p = std::make_shared<char>();
+    {
+        raphia::static_circ_buffer<std::shared_ptr<char>, 4> circ;
+        for (auto _ = 6; _--;)
+            circ.push_back(p);
+        CHECK(p.use_count() == 5);
+        SECTION("copy")
+        {
+            auto copy = circ;
+            CHECK(p.use_count() == 9);
+        }
+        SECTION("move")
+        {
+            auto moved = std::move(circ);
+            CHECK(p.use_count() == 5);
+            CHECK(circ.empty());
+            CHECK(moved.size() == 4);
+        }
+        SECTION("pop and clear")
+        {
+            circ.pop_back();
+            CHECK(p.use_count() == 4);
+            circ.clear();
+            CHECK(p.use_count() == 1);
+        }
+    }
+    CHECK(p.use_count() == 1);
+}
+
+TEST_CASE("static_circ_buffer with placement new", "[static][ctor]")
+{
+    using circ_type = raphia::static_circ_buffer<int, 16>;
+    typename std::aligned_storage<sizeof(circ_type), alignof(circ_type)>::type storage;
+    auto circ = new (&storage) circ_type();
+    for (int i = 0; i < 20; ++i)
+        circ->push_back(i);
+    CHECK(circ->front() == 4);
+    CHECK(circ->back() == 19);
+    circ->~circ_type();
+}
+
+TEST_CASE("static_circ_buffer with pow2_index", "[static][index]")
+{
+    raphia::static_circ_buffer<char, 8, raphia::pow2_index> circ;
+    std::string str = "Hello World";
+    SECTION("push_front lets the counters wrap around zero")
+    {
+        std::copy(str.begin(), str.end(), std::front_inserter(circ));
+        CHECK(circ.size() == 8);
+        CHECK(std::string(circ.begin(), circ.end()) == "dlroW ol");
+        CHECK(std::string(circ.array_one().begin(), circ.array_one().end()) == "dlr");
+        CHECK(std::string(circ.array_two().begin(), circ.array_two().end()) == "oW ol");
+        circ.push_back('!');
+        CHECK(std::string(circ.begin(), circ.end()) == "lroW ol!");
+    }
+    SECTION("push_back overwrites the oldest elements")
+    {
+        circ.push_back(str.begin(), str.end());
+        CHECK(std::string(circ.begin(), circ.end()) == "lo World");
+        CHECK(circ.at(7) == 'd');
+    }
+}
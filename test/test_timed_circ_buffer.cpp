@@ -0,0 +1,117 @@
+#include "raphia/timed_circ_buffer.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using timed_buffer = raphia::timed_circ_buffer<int>;
+
+    timed_buffer::time_point at(int ms)
+    {
+        return timed_buffer::time_point(std::chrono::milliseconds(ms));
+    }
+
+    std::vector<int> values(std::pair<timed_buffer::const_iterator, timed_buffer::const_iterator> range)
+    {
+        return std::vector<int>(range.first, range.second);
+    }
+} // namespace
+
+TEST_CASE("timed_circ_buffer::timed_circ_buffer(size_type)", "[timed][ctor]")
+{
+    timed_buffer circ(5);
+    CHECK(circ.capacity() == 5);
+    CHECK(circ.empty());
+    CHECK(circ.lower_bound(at(0)) == 0);
+    CHECK(circ.expire_before(at(10)) == 0);
+    raphia::timed_circ_buffer<int, std::chrono::steady_clock, std::allocator<int>, raphia::pow2_index> pow2(5);
+    CHECK(pow2.capacity() == 8);
+}
+
+TEST_CASE("timed_circ_buffer::push_back()", "[timed][modifier]")
+{
+    timed_buffer circ(4);
+    SECTION("overwrites the oldest element when full")
+    {
+        for (int i = 0; i < 6; ++i)
+            circ.push_back(at(i * 10), i);
+        CHECK(circ.size() == 4);
+        CHECK(circ.values().front() == 2);
+        CHECK(circ.times().front() == at(20));
+        CHECK(circ.times().back() == at(50));
+    }
+    SECTION("timestamps must not decrease")
+    {
+        circ.push_back(at(10), 1);
+        circ.push_back(at(10), 2);
+        CHECK_THROWS_AS(circ.push_back(at(9), 3), std::invalid_argument);
+        CHECK(circ.size() == 2);
+    }
+    SECTION("stamp with the clock")
+    {
+        circ.push_back(1);
+        circ.push_back(2);
+        CHECK(circ.times().front() <= circ.times().back());
+        CHECK(circ.times().back() <= std::chrono::steady_clock::now());
+    }
+}
+
+TEST_CASE("timed_circ_buffer queries", "[timed][lookup]")
+{
+    timed_buffer circ(6);
+    // push past the capacity, so the elements span both segments
+    for (int i = 0; i < 9; ++i)
+        circ.push_back(at(i * 10 - (i & 1)), i); // 0 9 20 29 40 49 60 69 80
+    SECTION("range")
+    {
+        CHECK(values(circ.range(at(40), at(69))) == std::vector<int>({4, 5, 6, 7}));
+        CHECK(values(circ.range(at(41), at(68))) == std::vector<int>({5, 6}));
+        CHECK(values(circ.range(at(0), at(1000))) == std::vector<int>({3, 4, 5, 6, 7, 8}));
+        CHECK(values(circ.range(at(81), at(1000))).empty());
+        CHECK(values(circ.range(at(0), at(28))).empty());
+        CHECK(values(circ.range(at(60), at(50))).empty());
+    }
+    SECTION("equal timestamps")
+    {
+        circ.push_back(at(80), 9);
+        circ.push_back(at(80), 10);
+        CHECK(circ.lower_bound(at(80)) == 3);
+        CHECK(circ.upper_bound(at(80)) == 6);
+        CHECK(values(circ.range(at(80), at(80))) == std::vector<int>({8, 9, 10}));
+    }
+    SECTION("expire_before")
+    {
+        CHECK(circ.expire_before(at(49)) == 2);
+        CHECK(circ.values().front() == 5);
+        CHECK(circ.expire_before(at(49)) == 0);
+        CHECK(circ.expire_before(at(81)) == 4);
+        CHECK(circ.empty());
+        circ.push_back(at(90), 9);
+        CHECK(circ.values().front() == 9);
+    }
+}
+
+TEST_CASE("timed_circ_buffer matches a linear scan", "[timed][lookup]")
+{
+    timed_buffer circ(50);
+    std::mt19937 rng(3);
+    int now = 0;
+    bool same = true;
+    for (int round = 0; round < 2000; ++round)
+    {
+        now += static_cast<int>(rng() % 3);
+        circ.push_back(at(now), round);
+        if (rng() % 8 == 0)
+            circ.expire_before(at(now - static_cast<int>(rng() % 40)));
+        auto t0 = at(now - static_cast<int>(rng() % 60));
+        auto t1 = t0 + std::chrono::milliseconds(rng() % 30);
+        std::vector<int> expected;
+        for (std::size_t i = 0; i < circ.size(); ++i)
+            if (t0 <= circ.times()[static_cast<int>(i)] && circ.times()[static_cast<int>(i)] <= t1)
+                expected.push_back(circ.values()[static_cast<int>(i)]);
+        same = same && values(circ.range(t0, t1)) == expected;
+    }
+    CHECK(same);
+}
@@ -0,0 +1,102 @@
+#include "raphia/windowed_aggregate.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+
+TEST_CASE("windowed_aggregate::windowed_aggregate(size_type)", "[aggregate][ctor]")
+{
+    raphia::windowed_aggregate<int> window(4);
+    SECTION("is empty")
+    {
+        CHECK(window.empty());
+        CHECK(window.capacity() == 4);
+        CHECK(window.sum() == 0);
+        CHECK(window.mean() == 0);
+        CHECK(window.variance() == 0);
+    }
+    SECTION("min and max throw")
+    {
+        CHECK_THROWS_AS(window.min(), std::underflow_error);
+        CHECK_THROWS_AS(window.max(), std::underflow_error);
+    }
+}
+
+TEST_CASE("windowed_aggregate::push_back()", "[aggregate][modifier]")
+{
+    raphia::windowed_aggregate<int> window(4);
+    for (int v : {3, 1, 4, 1})
+        window.push_back(v);
+    SECTION("aggregates of a full window")
+    {
+        CHECK(window.sum() == 9);
+        CHECK(window.mean() == Approx(2.25));
+        CHECK(window.variance() == Approx(1.6875));
+        CHECK(window.min() == 1);
+        CHECK(window.max() == 4);
+    }
+    SECTION("the oldest value leaves a full window")
+    {
+        window.push_back(5);
+        window.push_back(9);
+        CHECK(window.size() == 4);
+        CHECK(window.sum() == 19);
+        CHECK(window.min() == 1);
+        CHECK(window.max() == 9);
+        window.push_back(2);
+        window.push_back(6);
+        CHECK(window.min() == 2);
+        CHECK(window.max() == 9);
+    }
+    SECTION("pop_front and clear")
+    {
+        window.pop_front();
+        window.pop_front();
+        CHECK(window.sum() == 5);
+        CHECK(window.min() == 1);
+        CHECK(window.max() == 4);
+        window.clear();
+        CHECK(window.empty());
+        CHECK(window.sum() == 0);
+        window.push_back(7);
+        CHECK(window.min() == 7);
+        CHECK(window.max() == 7);
+        CHECK(window.variance() == 0);
+    }
+    SECTION("custom ordering")
+    {
+        raphia::windowed_aggregate<int, std::greater<int>> reversed(4);
+        for (int v : {3, 1, 4, 1})
+            reversed.push_back(v);
+        CHECK(reversed.min() == 4);
+        CHECK(reversed.max() == 1);
+    }
+}
+
+TEST_CASE("windowed_aggregate matches a full recomputation", "[aggregate]")
+{
+    raphia::windowed_aggregate<double> window(50);
+    std::uint32_t seed = 1;
+    for (int i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        window.push_back(static_cast<double>(seed >> 16) / 100.0);
+        if (i % 7 == 0)
+            window.pop_front();
+        if (window.empty())
+            continue;
+        auto &values = window.window();
+        auto n = static_cast<double>(values.size());
+        auto sum = std::accumulate(values.begin(), values.end(), 0.0);
+        auto mean = sum / n;
+        auto m2 = 0.0;
+        for (auto v : values)
+            m2 += (v - mean) * (v - mean);
+        REQUIRE(window.sum() == Approx(sum));
+        REQUIRE(window.mean() == Approx(mean));
+        REQUIRE(window.variance() == Approx(values.size() < 2 ? 0.0 : m2 / n).margin(1e-6));
+        REQUIRE(window.min() == *std::min_element(values.begin(), values.end()));
+        REQUIRE(window.max() == *std::max_element(values.begin(), values.end()));
+    }
+}
@@ -0,0 +1,77 @@
+#include "raphia/windowed_histogram.hpp"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("log_histogram", "[histogram]")
+{
+    SECTION("invalid arguments throw")
+    {
+        CHECK_THROWS_AS(raphia::log_histogram(0, 10), std::invalid_argument);
+        CHECK_THROWS_AS(raphia::log_histogram(10, 1), std::invalid_argument);
+        CHECK_THROWS_AS(raphia::log_histogram(1, 10, 17), std::invalid_argument);
+    }
+    raphia::log_histogram histogram(1, 1e6, 7);
+    SECTION("empty histogram")
+    {
+        CHECK(histogram.count() == 0);
+        CHECK(histogram.quantile(0.5) == 0);
+    }
+    SECTION("quantiles are within the bucket precision")
+    {
+        for (int i = 1; i <= 1000; ++i)
+            histogram.add(i);
+        CHECK(histogram.count() == 1000);
+        CHECK(histogram.quantile(0.5) == Approx(500).epsilon(1.0 / 128));
+        CHECK(histogram.quantile(0.99) == Approx(990).epsilon(1.0 / 128));
+        CHECK(histogram.quantile(1) == Approx(1000).epsilon(1.0 / 128));
+        CHECK(histogram.quantile(0) == Approx(1).epsilon(1.0 / 128));
+    }
+    SECTION("removed values no longer count")
+    {
+        for (int i = 1; i <= 100; ++i)
+            histogram.add(i);
+        for (int i = 51; i <= 100; ++i)
+            histogram.remove(i);
+        CHECK(histogram.count() == 50);
+        CHECK(histogram.quantile(1) == Approx(50).epsilon(1.0 / 128));
+        histogram.clear();
+        CHECK(histogram.count() == 0);
+    }
+    SECTION("values out of range are clamped")
+    {
+        histogram.add(-5);
+        histogram.add(1e9);
+        CHECK(histogram.count() == 2);
+        CHECK(histogram.quantile(0) < 1.01);
+        CHECK(histogram.quantile(1) > 1e6 / 2);
+    }
+}
+
+TEST_CASE("windowed_histogram tracks the values in the window", "[histogram]")
+{
+    raphia::windowed_histogram<double> window(100, 1, 1 << 20);
+    std::uint32_t seed = 1;
+    for (int i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        window.push_back(static_cast<double>(seed >> 12) + 1);
+        if (i % 13 == 0)
+            window.pop_front();
+        REQUIRE(window.histogram().count() == window.size());
+        if (i % 50 != 49)
+            continue;
+        std::vector<double> values(window.window().begin(), window.window().end());
+        std::sort(values.begin(), values.end());
+        for (double q : {0.5, 0.9, 0.99})
+        {
+            auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(values.size())));
+            REQUIRE(window.quantile(q) == Approx(values[rank - 1]).epsilon(1.0 / 128));
+        }
+    }
+    window.clear();
+    CHECK(window.empty());
+    CHECK(window.histogram().count() == 0);
+}